@@ -0,0 +1,93 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "allocation_counter.hpp"
+#include "game_state.hpp"
+
+// Minimal benchmark harness: each benchmark is calibrated to an iteration
+// count that takes at least minSampleMs, then timed over several samples.
+// Results are kept and printed together as JSON.
+
+struct BenchmarkResult {
+    std::string name;
+    int mapSize;     // 0 when the benchmark doesn't depend on it
+    int unitCount;   // 0 when the benchmark doesn't depend on it
+    long iterations; // per sample
+    double nsPerOp;  // median over samples
+    double nsPerOpMin;
+    double allocationsPerOp;  // heap allocations on the benchmark's thread, over the timed samples
+};
+
+// Keeps the compiler from discarding a result that is otherwise unused
+template <typename T>
+inline void doNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+class BenchmarkRunner {
+public:
+    BenchmarkRunner(double minSampleMs, int samples, const std::string& filter)
+        : minSampleMs(minSampleMs), samples(samples), filter(filter) {}
+
+    bool enabled(const std::string& name) const { return filter.empty() || name.find(filter) != std::string::npos; }
+
+    // op(i) performs the i-th operation
+    template <typename Op>
+    void run(const std::string& name, int mapSize, int unitCount, Op op) {
+        if (!enabled(name)) return;
+        long iterations = 1;
+        while (true) {
+            double ms = timeBatch(op, iterations);
+            if (ms >= minSampleMs || iterations >= (1L << 40)) break;
+            // Aim a bit past the target so calibration usually ends in one more step
+            double scale = ms > 0.0 ? 1.2 * minSampleMs / ms : 100.0;
+            iterations = std::max(iterations + 1, static_cast<long>(iterations * std::min(scale, 100.0)));
+        }
+
+        std::vector<double> nsPerOp;
+        nsPerOp.reserve(samples);
+        AllocationScope allocations;
+        for (int sample = 0; sample < samples; sample++) {
+            nsPerOp.push_back(timeBatch(op, iterations) * 1e6 / iterations);
+        }
+        double allocationsPerOp = static_cast<double>(allocations.allocations()) / (static_cast<double>(iterations) * samples);
+        std::sort(nsPerOp.begin(), nsPerOp.end());
+        results.push_back({name, mapSize, unitCount, iterations, nsPerOp[nsPerOp.size() / 2], nsPerOp.front(), allocationsPerOp});
+    }
+
+    void printJson(std::ostream& out) const;
+
+private:
+    double minSampleMs;
+    int samples;
+    std::string filter;
+    std::vector<BenchmarkResult> results;
+
+    template <typename Op>
+    static double timeBatch(Op& op, long iterations) {
+        auto start = std::chrono::steady_clock::now();
+        for (long i = 0; i < iterations; i++) {
+            op(i);
+        }
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+};
+
+// Square generated map with unitCount units of random types on passable
+// tiles, split between players 1 and 2; the same arguments give the same game
+GameState makeScenario(int mapSize, int unitCount, unsigned seed);
+
+#ifdef BATTLE_RENDER_BENCHMARKS
+// Full frames on SDL's software renderer with the dummy video driver
+void runRenderBenchmarks(BenchmarkRunner& runner, const std::vector<int>& mapSizes, const std::vector<int>& unitCounts);
+#endif
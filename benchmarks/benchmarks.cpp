@@ -0,0 +1,309 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include "benchmark.hpp"
+#include "flood_fill.hpp"
+#include "fog_of_war.hpp"
+#include "map_generator.hpp"
+#include "rules.hpp"
+#include "threat_map.hpp"
+
+// Self-contained micro-benchmarks of the simulation hot paths (and, when
+// built with SDL, of a rendered frame). Every input is generated from fixed
+// seeds, so two runs on the same machine measure the same work.
+//
+//   benchmarks [--sizes 64,256,1024] [--units 16,256] [--filter NAME]
+//              [--min-time-ms 50] [--samples 5] [--out FILE]
+
+namespace {
+
+const unsigned SEED = 12345;
+
+std::vector<int> parseList(const char* text) {
+    std::vector<int> values;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        int value = std::atoi(item.c_str());
+        if (value > 0) values.push_back(value);
+    }
+    return values;
+}
+
+void writeJsonString(std::ostream& out, const std::string& text) {
+    out << '"';
+    for (char c : text) {
+        if (c == '"' || c == '\\') out << '\\';
+        out << c;
+    }
+    out << '"';
+}
+
+bool writeTextUnits(const std::vector<Unit>& units, const std::string& filename) {
+    static const char symbols[UNIT_TYPE_COUNT] = {'I', 'T', 'B', 'H'};
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Unable to write unit file: " << filename << std::endl;
+        return false;
+    }
+    for (const Unit& unit : units) {
+        file << symbols[unit.getType()] << ' ' << unit.getX() << ' ' << unit.getY() << ' ' << unit.getOrientation() << '\n';
+    }
+    return static_cast<bool>(file);
+}
+
+void runRangeBenchmarks(BenchmarkRunner& runner, int mapSize, int unitCount) {
+    GameState state = makeScenario(mapSize, unitCount, SEED);
+    std::vector<Unit> units = state.getUnits().toVector();
+    if (units.empty()) return;
+    const Map& map = state.getMap();
+    const OccupancyGrid& occupancy = state.getOccupancy();
+
+    // Into a reused buffer, as the range cache does
+    std::vector<Point> out;
+    runner.run("movement_range", mapSize, unitCount, [&](long i) {
+        calculateMovementRange(units[i % units.size()], map, occupancy, out);
+        doNotOptimize(out);
+    });
+    // The same flood fill with the range and passability grid picked at
+    // runtime, as before the per-type kernels
+    runner.run("movement_range_generic", mapSize, unitCount, [&](long i) {
+        const Unit& unit = units[i % units.size()];
+        out.clear();
+        floodFillRange(map.getPassability(unit.getType()), occupancy.getOccupied(), occupancy.getPlayerTiles(unit.getPlayer()),
+                       unit.getX(), unit.getY(), unit.getMoveRange(), out);
+        doNotOptimize(out);
+    });
+    runner.run("movement_range_scan", mapSize, unitCount, [&](long i) {
+        calculateMovementRange(units[i % units.size()], map, state.getUnits(), out);
+        doNotOptimize(out);
+    });
+    runner.run("movement_range_scalar", mapSize, unitCount, [&](long i) {
+        const Unit& unit = units[i % units.size()];
+        out.clear();
+        floodFillRangeScalar(map.getPassability(unit.getType()), occupancy.getOccupied(), occupancy.getPlayerTiles(unit.getPlayer()),
+                             unit.getX(), unit.getY(), unit.getMoveRange(), out);
+        doNotOptimize(out);
+    });
+    // Every unit's range per call, one type group at a time
+    std::vector<int> indices(units.size());
+    for (size_t i = 0; i < indices.size(); i++) indices[i] = static_cast<int>(i);
+    std::vector<std::vector<Point>> ranges;
+    runner.run("movement_range_batch", mapSize, unitCount, [&](long) {
+        floodFillRanges(state.getUnits(), indices, map, occupancy, ranges);
+        doNotOptimize(ranges);
+    });
+    runner.run("attack_range", mapSize, unitCount, [&](long i) {
+        calculateAttackRange(units[i % units.size()], map, out);
+        doNotOptimize(out);
+    });
+}
+
+void runVisibilityBenchmarks(BenchmarkRunner& runner, int mapSize, int unitCount) {
+    if (!runner.enabled("visibility")) return;
+    GameState state = makeScenario(mapSize, unitCount, SEED);
+    const UnitPool& units = state.getUnits();
+    if (units.empty()) return;
+
+    FogOfWar fog;
+    runner.run("visibility_rebuild", mapSize, unitCount, [&](long) {
+        fog.rebuild(state);
+        doNotOptimize(fog.getVisible(1));
+    });
+    // The unit stays put; the update redoes the same tiles as a real step
+    // from the neighbouring tile would
+    runner.run("visibility_move", mapSize, unitCount, [&](long i) {
+        int index = static_cast<int>(i % units.size());
+        Point to = {units.getX(index), units.getY(index)};
+        doNotOptimize(fog.unitMoved(state, index, {to.x > 0 ? to.x - 1 : to.x + 1, to.y}, to));
+    });
+}
+
+void runThreatBenchmarks(BenchmarkRunner& runner, int mapSize, int unitCount) {
+    if (!runner.enabled("threat")) return;
+    GameState state = makeScenario(mapSize, unitCount, SEED);
+    const UnitPool& units = state.getUnits();
+    if (units.empty()) return;
+
+    ThreatMap threats;
+    runner.run("threat_rebuild", mapSize, unitCount, [&](long) {
+        threats.rebuild(state);
+        doNotOptimize(threats.row(THREAT_AFTER_MOVE, 1, 0));
+    });
+    // As visibility_move: the unit stays put, the update does a real step's work
+    runner.run("threat_move", mapSize, unitCount, [&](long i) {
+        int index = static_cast<int>(i % units.size());
+        Point to = {units.getX(index), units.getY(index)};
+        doNotOptimize(threats.unitMoved(state, index, {to.x > 0 ? to.x - 1 : to.x + 1, to.y}, to));
+    });
+    // What the map replaces: one unit's attack range from every tile it can
+    // reach, merged per unit and added up
+    const Map& map = state.getMap();
+    std::vector<int> damage(static_cast<size_t>(mapSize) * mapSize);
+    std::vector<long> markedBy(damage.size(), -1);
+    long mark = 0;
+    std::vector<Point> reachable, attackable;
+    runner.run("threat_from_ranges", mapSize, unitCount, [&](long) {
+        std::fill(damage.begin(), damage.end(), 0);
+        for (int index = 0; index < units.size(); index++) {
+            Unit unit = units.get(index);
+            mark++;
+            calculateMovementRange(unit, map, state.getOccupancy(), reachable);
+            reachable.push_back({unit.getX(), unit.getY()});
+            for (Point from : reachable) {
+                unit.setPosition(from.x, from.y);
+                calculateAttackRange(unit, map, attackable);
+                for (Point tile : attackable) {
+                    size_t at = static_cast<size_t>(tile.y) * mapSize + tile.x;
+                    if (markedBy[at] == mark) continue;
+                    markedBy[at] = mark;
+                    damage[at] += unit.getAttackDamage();
+                }
+            }
+        }
+        doNotOptimize(damage);
+    });
+}
+
+void runMapLoadBenchmarks(BenchmarkRunner& runner, int mapSize, const std::filesystem::path& directory) {
+    if (!runner.enabled("load_map")) return;
+    Map map(mapSize, mapSize);
+    generateTerrain(map, SEED);
+    std::string textFile = (directory / ("map_" + std::to_string(mapSize) + ".txt")).string();
+    std::string binaryFile = (directory / ("map_" + std::to_string(mapSize) + ".bmap")).string();
+    if (!map.saveMap(textFile) || !map.saveBinaryMap(binaryFile)) return;
+
+    runner.run("load_map_text", mapSize, 0, [&](long) {
+        Map loaded(mapSize, mapSize);
+        doNotOptimize(loaded.loadMap(textFile));
+    });
+    runner.run("load_map_binary", mapSize, 0, [&](long) {
+        Map loaded(0, 0);
+        doNotOptimize(loaded.loadMap(binaryFile));
+    });
+}
+
+void runUnitLoadBenchmarks(BenchmarkRunner& runner, int unitCount, const std::filesystem::path& directory) {
+    if (!runner.enabled("load_units")) return;
+    // Large enough to place any requested count without crowding
+    int mapSize = 64;
+    while (mapSize * mapSize < unitCount * 8) mapSize *= 2;
+    GameState state = makeScenario(mapSize, unitCount, SEED);
+    std::string textFile = (directory / ("units_" + std::to_string(unitCount) + ".txt")).string();
+    std::string binaryFile = (directory / ("units_" + std::to_string(unitCount) + ".bunits")).string();
+    std::vector<Unit> units = state.getUnits().toVector();
+    if (!writeTextUnits(units, textFile) || !saveBinaryUnits(units, binaryFile)) return;
+
+    runner.run("load_units_text", 0, unitCount, [&](long) {
+        units.clear();
+        doNotOptimize(loadUnits(textFile, 1, units));
+    });
+    runner.run("load_units_binary", 0, unitCount, [&](long) {
+        units.clear();
+        doNotOptimize(loadUnits(binaryFile, 1, units));
+    });
+}
+
+}
+
+GameState makeScenario(int mapSize, int unitCount, unsigned seed) {
+    GameState state(mapSize, mapSize);
+    generateTerrain(state.getMutableMap(), seed);
+    const Map& map = state.getMap();
+
+    std::mt19937 random(seed);
+    std::uniform_int_distribution<int> coordinate(0, mapSize - 1);
+    std::uniform_int_distribution<int> unitType(0, UNIT_TYPE_COUNT - 1);
+    int placed = 0;
+    for (long attempt = 0; placed < unitCount && attempt < 100L * unitCount; attempt++) {
+        int x = coordinate(random), y = coordinate(random);
+        UnitType type = static_cast<UnitType>(unitType(random));
+        if (!map.isPassable(type, x, y) || state.unitAt(x, y) != -1) continue;
+        state.addUnit(Unit(type, x, y, 1 + placed % 2, 0));
+        placed++;
+    }
+    return state;
+}
+
+void BenchmarkRunner::printJson(std::ostream& out) const {
+    out << "{\n  \"min_sample_ms\": " << minSampleMs << ",\n  \"samples\": " << samples << ",\n  \"benchmarks\": [";
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchmarkResult& result = results[i];
+        out << (i == 0 ? "\n" : ",\n") << "    {\"name\": ";
+        writeJsonString(out, result.name);
+        out << ", \"map_size\": " << result.mapSize << ", \"units\": " << result.unitCount
+            << ", \"iterations\": " << result.iterations << ", \"ns_per_op\": " << result.nsPerOp
+            << ", \"ns_per_op_min\": " << result.nsPerOpMin << ", \"allocs_per_op\": " << result.allocationsPerOp << "}";
+    }
+    out << "\n  ]\n}" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<int> mapSizes = {64, 256, 1024};
+    std::vector<int> unitCounts = {16, 256};
+    std::string filter;
+    std::string outFile;
+    double minSampleMs = 50.0;
+    int samples = 5;
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--sizes") == 0 && i + 1 < argc) {
+            mapSizes = parseList(argv[++i]);
+        } else if (std::strcmp(argv[i], "--units") == 0 && i + 1 < argc) {
+            unitCounts = parseList(argv[++i]);
+        } else if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (std::strcmp(argv[i], "--min-time-ms") == 0 && i + 1 < argc) {
+            minSampleMs = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--samples") == 0 && i + 1 < argc) {
+            samples = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            outFile = argv[++i];
+        } else {
+            std::cerr << "Unknown option: " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::path directory = std::filesystem::temp_directory_path(error) / "battle_benchmarks";
+    std::filesystem::create_directories(directory, error);
+    if (error) {
+        std::cerr << "Unable to create " << directory << ": " << error.message() << std::endl;
+        return 1;
+    }
+
+    BenchmarkRunner runner(minSampleMs, samples, filter);
+    for (int mapSize : mapSizes) {
+        for (int unitCount : unitCounts) {
+            runRangeBenchmarks(runner, mapSize, unitCount);
+            runVisibilityBenchmarks(runner, mapSize, unitCount);
+            runThreatBenchmarks(runner, mapSize, unitCount);
+        }
+        runMapLoadBenchmarks(runner, mapSize, directory);
+    }
+    for (int unitCount : unitCounts) {
+        runUnitLoadBenchmarks(runner, unitCount, directory);
+    }
+#ifdef BATTLE_RENDER_BENCHMARKS
+    runRenderBenchmarks(runner, mapSizes, unitCounts);
+#endif
+    std::filesystem::remove_all(directory, error);
+
+    if (outFile.empty()) {
+        runner.printJson(std::cout);
+    } else {
+        std::ofstream out(outFile);
+        if (!out.is_open()) {
+            std::cerr << "Unable to write " << outFile << std::endl;
+            return 1;
+        }
+        runner.printJson(out);
+    }
+    return 0;
+}
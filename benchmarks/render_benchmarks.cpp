@@ -0,0 +1,92 @@
+#include <SDL.h>
+#include <SDL_image.h>
+#include <filesystem>
+#include <iostream>
+#include "animation_scheduler.hpp"
+#include "asset_cache.hpp"
+#include "benchmark.hpp"
+#include "game_renderer.hpp"
+
+// Frames rendered headless: the dummy video driver and a software renderer
+// drawing into a plain surface the size of the game window.
+
+namespace {
+
+const int SCREEN_WIDTH = 640;
+const int SCREEN_HEIGHT = 640;
+const int TILE_SIZE = 64;
+const unsigned SEED = 12345;
+// Written by the atlas target next to the benchmarks binary
+const char* ATLAS_FILE = "atlas/sprites.atlas";
+
+void runFrameBenchmarks(BenchmarkRunner& runner, SDL_Renderer* renderer, int mapSize, int unitCount) {
+    GameState state = makeScenario(mapSize, unitCount, SEED);
+
+    AssetCache assets(renderer);
+    assets.preload(SpriteAtlas::imagePaths(ATLAS_FILE, TILE_SIZE));
+
+    GameRenderer gameRenderer(renderer, TILE_SIZE, state);
+    if (!gameRenderer.load(assets, ATLAS_FILE)) return;
+    // Look at the middle of the map, where units are spread evenly
+    gameRenderer.getCamera().centerOn(mapSize * TILE_SIZE / 2.0, mapSize * TILE_SIZE / 2.0);
+    AnimationScheduler animations;
+
+    // Terrain chunks already baked: the steady-state cost of a frame
+    runner.run("render_frame", mapSize, unitCount, [&](long) {
+        gameRenderer.markAllDirty();
+        doNotOptimize(gameRenderer.renderFrame(state, animations));
+    });
+    // Every chunk re-baked, as after a jump to an unseen part of the map
+    runner.run("render_frame_cold", mapSize, unitCount, [&](long) {
+        gameRenderer.reset();
+        doNotOptimize(gameRenderer.renderFrame(state, animations));
+    });
+
+    // The same steady-state frame drawn from the loose source images, one texture per sheet
+    if (!gameRenderer.getSprites().isPacked() || !runner.enabled("render_frame_loose")) return;
+    GameRenderer looseRenderer(renderer, TILE_SIZE, state);
+    if (!looseRenderer.load(assets, "")) return;
+    looseRenderer.getCamera().centerOn(mapSize * TILE_SIZE / 2.0, mapSize * TILE_SIZE / 2.0);
+    runner.run("render_frame_loose", mapSize, unitCount, [&](long) {
+        looseRenderer.markAllDirty();
+        doNotOptimize(looseRenderer.renderFrame(state, animations));
+    });
+}
+
+}
+
+void runRenderBenchmarks(BenchmarkRunner& runner, const std::vector<int>& mapSizes, const std::vector<int>& unitCounts) {
+    if (!runner.enabled("render_frame")) return;
+    if (!std::filesystem::exists("resources/gfx")) {
+        std::cerr << "resources/ not found in the working directory, skipping render benchmarks" << std::endl;
+        return;
+    }
+
+    SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy");
+    if (SDL_Init(SDL_INIT_VIDEO) != 0) {
+        std::cerr << "SDL_Init Error: " << SDL_GetError() << std::endl;
+        return;
+    }
+    if (!(IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG)) {
+        std::cerr << "IMG_Init Error: " << IMG_GetError() << std::endl;
+        SDL_Quit();
+        return;
+    }
+
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, SCREEN_WIDTH, SCREEN_HEIGHT, 32, SDL_PIXELFORMAT_RGBA8888);
+    SDL_Renderer* renderer = surface ? SDL_CreateSoftwareRenderer(surface) : nullptr;
+    if (!renderer) {
+        std::cerr << "Software renderer Error: " << SDL_GetError() << std::endl;
+    } else {
+        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+        for (int mapSize : mapSizes) {
+            for (int unitCount : unitCounts) {
+                runFrameBenchmarks(runner, renderer, mapSize, unitCount);
+            }
+        }
+        SDL_DestroyRenderer(renderer);
+    }
+    if (surface) SDL_FreeSurface(surface);
+    IMG_Quit();
+    SDL_Quit();
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "game_state.hpp"
+#include "thread_pool.hpp"
+
+// One turn: SELECT the unit's tile, then MOVE or ATTACK (x, y)
+struct AiAction {
+    CommandType type = MOVE;
+    int unitIndex = -1;
+    int x = -1;
+    int y = -1;
+};
+
+struct AiSettings {
+    int timeBudgetMs = 500;  // per move; the deepest finished iteration wins
+    int maxDepth = 64;       // in turns
+    // 0 for one per hardware thread. 1 searches on the calling thread, which
+    // makes a search limited by maxDepth rather than time deterministic.
+    unsigned threads = 0;
+    int tableBits = 20;      // transposition table holds 2^tableBits entries
+};
+
+struct AiStats {
+    int depth = 0;           // deepest fully searched iteration
+    int score = 0;           // for the player to move, at that depth
+    uint64_t nodes = 0;      // states visited, including unfinished iterations
+    double seconds = 0.0;
+
+    double nodesPerSecond() const { return seconds > 0.0 ? nodes / seconds : 0.0; }
+};
+
+// Shared by all search threads without locks: each slot stores its key
+// xor'ed with its data, so a torn write from two threads fails the check on
+// the next probe instead of returning another position's entry.
+class TranspositionTable {
+public:
+    enum Bound { EXACT, LOWER, UPPER };
+
+    struct Entry {
+        int score;
+        int depth;
+        Bound bound;
+        int move;  // index into generateActions() order, -1 for none
+    };
+
+    explicit TranspositionTable(int bits);
+
+    bool probe(uint64_t key, Entry& entry) const;
+    void store(uint64_t key, const Entry& entry);
+    void clear();
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> check{0};
+        std::atomic<uint64_t> data{0};
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    uint64_t mask;
+};
+
+// Alpha-beta search, one turn per ply, with iterative deepening under a time
+// budget. Each search task steps and undoes turns on its own copy of the
+// root state rather than copying the state per node. After the first root action has
+// set a bound, the remaining root actions are searched in parallel on a
+// work-stealing pool, all sharing one transposition table.
+class AiPlayer {
+public:
+    explicit AiPlayer(const AiSettings& settings = AiSettings());
+
+    // Best action for the player to move; false if the game is over or the
+    // player has nothing to do
+    bool chooseAction(const GameState& state, AiAction& action);
+    const AiStats& getLastStats() const { return lastStats; }
+    const AiSettings& getSettings() const { return settings; }
+
+    // Every legal turn of the player to move, built from the same movement
+    // and attack ranges that step() checks against
+    static void generateActions(const GameState& state, std::vector<AiAction>& actions);
+    // Feeds the action to step() as SELECT plus MOVE/ATTACK; the step result
+    // of the second command goes to `result` when given
+    static bool apply(GameState& state, const AiAction& action, StepResult* result = nullptr);
+    // Same, recording the turn for GameState::undo()
+    static bool apply(GameState& state, const AiAction& action, StepUndo& undo);
+    // Static score from the point of view of the player to move
+    static int evaluate(const GameState& state);
+
+private:
+    AiSettings settings;
+    std::unique_ptr<ThreadPool> pool;  // none when searching single-threaded
+    TranspositionTable table;
+    AiStats lastStats;
+};
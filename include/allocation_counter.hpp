@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+
+// Counts heap allocations made through operator new, per thread, so a frame,
+// a turn or a benchmark op can be checked for allocating in steady state.
+// The counting replacements of the global operator new/delete live in
+// src/allocation_hooks and are linked only into the executables that measure
+// (benchmarks, replay, battle_tests); elsewhere every count stays zero.
+// Memory SDL or other C libraries get from malloc is not seen.
+
+struct AllocationStats {
+    uint64_t allocations = 0;
+    uint64_t frees = 0;
+    uint64_t bytes = 0;  // requested by the allocations
+};
+
+bool allocationCountingEnabled();
+// Totals of the calling thread since it started
+AllocationStats threadAllocationStats();
+
+// For the hooks: the calling thread's live counters, and the switch that
+// makes allocationCountingEnabled() true
+AllocationStats& threadAllocationCounters();
+void enableAllocationCounting();
+
+// What the calling thread allocated since construction (or restart())
+class AllocationScope {
+public:
+    AllocationScope() : start(threadAllocationStats()) {}
+
+    void restart() { start = threadAllocationStats(); }
+    AllocationStats delta() const {
+        AllocationStats now = threadAllocationStats();
+        return {now.allocations - start.allocations, now.frees - start.frees, now.bytes - start.bytes};
+    }
+    uint64_t allocations() const { return delta().allocations; }
+
+private:
+    AllocationStats start;
+};
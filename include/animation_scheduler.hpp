@@ -0,0 +1,61 @@
+#pragma once
+
+#include <vector>
+#include "game_state.hpp"
+#include "sprite_catalog.hpp"
+
+struct UnitMoveAnimation {
+    UnitHandle unit;
+    std::vector<Point> path;  // tiles walked, starting with the origin
+    double elapsedMs = 0.0;
+};
+
+struct ExplosionAnimation {
+    Point tile;
+    double elapsedMs = 0.0;
+};
+
+// Advances unit walks and explosions on elapsed time instead of sleeping in
+// the frame loop. Time is consumed in fixed steps; positions in between are
+// interpolated, so several animations can play at once at any frame rate.
+class AnimationScheduler {
+public:
+    static constexpr double STEP_MS = 1000.0 / 60.0;
+    static constexpr double MOVE_MS_PER_TILE = 50.0;
+    static constexpr double EXPLOSION_FRAME_MS = 500.0;
+    static const int EXPLOSION_TOTAL_FRAMES = EXPLOSION_FRAMES;
+
+    void startMove(UnitHandle unit, const std::vector<Point>& path);
+    void startExplosion(Point tile);
+    // Drop any walk of a unit, e.g. because it just died
+    void cancelUnit(UnitHandle unit);
+
+    // Feed wall-clock time; unit orientation is updated as legs are entered.
+    // Walks of units that no longer exist are dropped.
+    void update(double elapsedMs, GameState& state);
+
+    bool isIdle() const { return moves.empty() && explosions.empty(); }
+    // Time until the next fixed step is due, for waiting on events meanwhile
+    double msUntilNextStep() const { return STEP_MS - accumulatorMs; }
+
+    // Interpolated pixel position (top-left of the tile box) of a walking unit
+    bool unitPosition(UnitHandle unit, int tileSize, int& pixelX, int& pixelY) const;
+    int explosionFrame(const ExplosionAnimation& explosion) const;
+    const std::vector<UnitMoveAnimation>& getMoves() const { return moves; }
+    const std::vector<ExplosionAnimation>& getExplosions() const { return explosions; }
+
+    // Tiles currently touched by any animation
+    void coveredTiles(int tileSize, std::vector<Point>& tiles) const;
+
+private:
+    std::vector<UnitMoveAnimation> moves;
+    std::vector<ExplosionAnimation> explosions;
+    std::vector<std::vector<Point>> sparePaths;  // of finished walks, reused by startMove
+    double accumulatorMs = 0.0;
+
+    void tick(GameState& state);
+    // Drop the moves `done` accepts, keeping their path buffers for reuse
+    template <typename Done>
+    void retireMoves(Done done);
+    double interpolatedElapsed(double elapsedMs) const { return elapsedMs + accumulatorMs; }
+};
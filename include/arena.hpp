@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+// Bump allocator for scratch memory that dies together: everything a frame or
+// a single range query needs is carved out of retained blocks and released at
+// once by reset() or by rewinding to a mark. Blocks are kept between uses, and
+// reset() merges them into one once the arena has overflowed, so after the
+// first few uses it no longer touches the heap.
+// Only trivially destructible types belong here; nothing is destroyed.
+class Arena {
+public:
+    static const size_t DEFAULT_BLOCK_BYTES = 64 * 1024;
+
+    struct Mark {
+        size_t block;
+        size_t offset;
+    };
+
+    explicit Arena(size_t blockBytes = DEFAULT_BLOCK_BYTES);
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+    // Uninitialized storage for `count` values
+    template <typename T>
+    T* allocateArray(size_t count) {
+        static_assert(std::is_trivially_destructible<T>::value, "arena memory is never destroyed");
+        return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+    }
+
+    Mark mark() const { return {current, offset}; }
+    // Frees everything allocated since `mark`
+    void rewind(Mark mark);
+    void reset();
+
+    size_t bytesUsed() const;
+    size_t highWaterBytes() const { return highWater; }
+    size_t capacityBytes() const;
+
+private:
+    struct Block {
+        std::unique_ptr<unsigned char[]> data;
+        size_t size;
+    };
+
+    size_t blockBytes;
+    std::vector<Block> blocks;
+    size_t current = 0;  // block being bumped
+    size_t offset = 0;   // into blocks[current]
+    size_t highWater = 0;
+};
+
+// Rewinds the arena when it goes out of scope, for per-query scratch
+class ArenaScope {
+public:
+    explicit ArenaScope(Arena& arena) : arena(arena), start(arena.mark()) {}
+    ~ArenaScope() { arena.rewind(start); }
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+private:
+    Arena& arena;
+    Arena::Mark start;
+};
+
+// This thread's arena for per-query scratch (range queries, flood fills).
+// Users take an ArenaScope around their allocations, so queries nest and the
+// arena is empty between them.
+Arena& scratchArena();
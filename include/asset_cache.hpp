@@ -0,0 +1,57 @@
+#pragma once
+
+#include <SDL.h>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct AssetStats {
+    int requests = 0;        // getTexture() calls
+    int cacheHits = 0;
+    int decodes = 0;         // PNGs actually decoded
+    size_t decodedBytes = 0; // pixel bytes of all decoded surfaces
+    double decodeMs = 0.0;   // wall time of the (parallel) decode phase
+    double uploadMs = 0.0;   // time spent creating textures on the render thread
+};
+
+// Path-keyed texture cache. Every path is decoded and uploaded once and handed
+// out as a shared texture that is destroyed when the last owner lets go.
+class AssetCache {
+public:
+    explicit AssetCache(SDL_Renderer* renderer);
+    ~AssetCache();
+
+    // Decode every path on worker threads, then upload the surfaces here.
+    // Must be called from the render thread. threads == 0 picks the core count.
+    void preload(const std::vector<std::string>& paths, unsigned threads = 0);
+
+    // Cached texture for path, loaded synchronously on a miss; nullptr on failure
+    std::shared_ptr<SDL_Texture> getTexture(const std::string& path);
+
+    // Drop cache entries nobody else holds any more
+    void releaseUnused();
+    void clear();
+
+    const AssetStats& getStats() const { return stats; }
+    void printStats(double startupMs) const;
+
+private:
+    SDL_Renderer* renderer;
+    std::unordered_map<std::string, std::shared_ptr<SDL_Texture>> textures;
+    AssetStats stats;
+
+    // A decoded image, or why it failed to decode. The error is read on the
+    // thread that ran IMG_Load, since that is where SDL keeps it.
+    struct Decoded {
+        SDL_Surface* surface = nullptr;
+        std::string error;
+    };
+
+    static Decoded decode(const std::string& path);
+    std::shared_ptr<SDL_Texture> upload(const std::string& path, const Decoded& decoded);
+};
+
+// Peak resident set size of the process so far, in bytes (0 if unavailable)
+size_t peakResidentBytes();
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "sprite_catalog.hpp"
+
+// Where every sprite of the catalogue sits in the packed atlas pages.
+// Sprites are stored pre-scaled to their box and trimmed to their opaque
+// pixels, so drawing one copies `rect` 1:1 to `offset` within its box.
+// Text format written by atlas_packer:
+//     atlas <version> <tileSize> <pageCount> <spriteCount>
+//     page <image file, relative to the layout file> <width> <height>
+//     sprite <id> <name> <page> <x> <y> <w> <h> <offsetX> <offsetY>
+
+const int ATLAS_LAYOUT_VERSION = 1;
+
+struct AtlasSprite {
+    int page = -1;  // -1: nothing opaque, drawn as nothing
+    int x = 0, y = 0, w = 0, h = 0;
+    int offsetX = 0, offsetY = 0;
+};
+
+struct AtlasPage {
+    std::string file;  // as a path relative to the working directory once loaded
+    int width = 0;
+    int height = 0;
+};
+
+struct AtlasLayout {
+    int tileSize = 0;
+    std::vector<AtlasPage> pages;
+    std::vector<AtlasSprite> sprites;  // indexed by sprite id, SPRITE_COUNT of them
+};
+
+// Page files come back resolved against the layout file's directory
+bool loadAtlasLayout(const std::string& filename, AtlasLayout& layout);
+// Page files are written as given, i.e. they should be relative to the layout file
+bool saveAtlasLayout(const AtlasLayout& layout, const std::string& filename);
+
+// Shelf packing, tallest sprites first, with `padding` free pixels around each
+// so filtering never bleeds between neighbours. Fills in page, x and y of
+// every sprite with a page != -1 from its w and h, and sizes the pages
+// (file names are left to the caller). False if a sprite exceeds pageSize.
+bool packAtlas(std::vector<AtlasSprite>& sprites, int pageSize, int padding, std::vector<AtlasPage>& pages);
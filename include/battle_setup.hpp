@@ -0,0 +1,22 @@
+#pragma once
+
+#include <string>
+#include "game_state.hpp"
+
+// Where a match's starting position comes from, as the game, `replay` and
+// `match_runner` take it from their command lines: a map file or generated
+// terrain, plus one unit layout per player.
+struct BattleSetup {
+    std::string mapFile = "resources/layouts/map.txt";
+    int randomWidth = 0;       // generated terrain of this size instead of the map file
+    int randomHeight = 0;
+    unsigned terrainSeed = 1;
+    std::string layouts[3] = {"", "resources/layouts/player1.txt", "resources/layouts/player2.txt"};
+    int maxMapSize = 0;        // larger maps are refused; 0 takes any size
+
+    bool randomMap() const { return randomWidth > 0 && randomHeight > 0; }
+};
+
+// Measures and loads the map or generates it, then loads both layouts into a
+// fresh state. Fails, saying why on std::cerr, if any part can't be loaded.
+bool loadBattle(const BattleSetup& setup, GameState& state);
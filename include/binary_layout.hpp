@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// On-disk formats for maps (.bmap) and unit layouts (.bunits). Both are
+// little-endian and laid out so a mapped file can be copied straight into
+// memory: no per-tile or per-unit parsing.
+//
+// .bmap:   MapFileHeader | terrain bytes (width * height, row-major)
+//          | padding to 8 | passability words per unit type
+//          (height * wordsPerRow uint64 each, same layout as BitGrid)
+// .bunits: UnitsFileHeader | UnitRecord * count
+// .bcl:    CommandLogHeader | command entries (see command_log.hpp)
+
+const uint32_t BINARY_LAYOUT_VERSION = 1;
+// 2: state hashes cover live units only, in unit pool order
+const uint32_t COMMAND_LOG_VERSION = 2;
+
+struct MapFileHeader {
+    char magic[4];           // "BNMP"
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t wordsPerRow;
+    uint32_t unitTypeCount;  // passability grids stored; 0 means recompute
+    uint64_t terrainOffset;
+    uint64_t passabilityOffset;
+};
+
+struct UnitRecord {
+    uint8_t type;
+    uint8_t player;
+    uint8_t orientation;
+    uint8_t reserved;
+    int32_t x;
+    int32_t y;
+};
+
+struct UnitsFileHeader {
+    char magic[4];           // "BNUL"
+    uint32_t version;
+    uint32_t count;
+    uint32_t recordSize;
+};
+
+struct CommandLogHeader {
+    char magic[4];           // "BNCL"
+    uint32_t version;
+    uint32_t mapWidth;
+    uint32_t mapHeight;
+    uint32_t unitCount;
+    uint32_t reserved;
+    uint64_t terrainHash;    // the map the match was played on
+    uint64_t initialHash;    // GameState::stateHash() before the first command
+    uint64_t byteCount;      // size of the entry stream
+};
+
+// Whether `count` bytes from `offset` lie within a file of `size` bytes. No
+// sum is formed, so offsets and counts from a hostile header can't wrap it.
+inline bool fitsInFile(uint64_t offset, uint64_t count, uint64_t size) {
+    return offset <= size && count <= size - offset;
+}
+
+static_assert(sizeof(MapFileHeader) == 40, "MapFileHeader layout changed");
+static_assert(sizeof(UnitRecord) == 12, "UnitRecord layout changed");
+static_assert(sizeof(UnitsFileHeader) == 16, "UnitsFileHeader layout changed");
+static_assert(sizeof(CommandLogHeader) == 48, "CommandLogHeader layout changed");
+
+inline bool hasExtension(const std::string& filename, const std::string& extension) {
+    return filename.size() >= extension.size() &&
+           filename.compare(filename.size() - extension.size(), extension.size(), extension) == 0;
+}
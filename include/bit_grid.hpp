@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// One bit per tile, row-major. Each row starts on a fresh 64-bit word so
+// whole rows can be shifted and masked word by word.
+class BitGrid {
+public:
+    BitGrid(int width = 0, int height = 0);
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    int getWordsPerRow() const { return wordsPerRow; }
+
+    bool test(int x, int y) const { return (words[y * wordsPerRow + (x >> 6)] >> (x & 63)) & 1; }
+    void set(int x, int y) { words[y * wordsPerRow + (x >> 6)] |= uint64_t(1) << (x & 63); }
+    void reset(int x, int y) { words[y * wordsPerRow + (x >> 6)] &= ~(uint64_t(1) << (x & 63)); }
+    void assign(int x, int y, bool value) { if (value) set(x, y); else reset(x, y); }
+
+    uint64_t* row(int y) { return &words[y * wordsPerRow]; }
+    const uint64_t* row(int y) const { return &words[y * wordsPerRow]; }
+    uint64_t* data() { return words.data(); }
+    const uint64_t* data() const { return words.data(); }
+    size_t wordCount() const { return words.size(); }
+
+    void clear();
+    // Set every tile bit, leaving the row padding clear
+    void fill();
+    size_t count() const;
+
+private:
+    int width, height;
+    int wordsPerRow;
+    std::vector<uint64_t> words;
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <SDL.h>
+
+// Scrollable, zoomable view onto the world. World coordinates are map pixels
+// at zoom 1 (tile * tileSize); screen coordinates are renderer pixels.
+class Camera {
+public:
+    static constexpr double MIN_ZOOM = 0.25;
+    static constexpr double MAX_ZOOM = 4.0;
+
+    Camera(int viewportWidth, int viewportHeight, int worldWidth, int worldHeight);
+
+    void setViewport(int width, int height);
+    void pan(double screenDeltaX, double screenDeltaY);
+    // Zoom by factor keeping the world point under (screenX, screenY) in place
+    void zoomAt(double factor, int screenX, int screenY);
+    void centerOn(double worldX, double worldY);
+
+    double getZoom() const { return zoom; }
+    int getViewportWidth() const { return viewportWidth; }
+    int getViewportHeight() const { return viewportHeight; }
+
+    // Edges are transformed separately so adjacent rects never leave gaps
+    SDL_Rect toScreen(const SDL_Rect& world) const;
+    double toWorldX(int screenX) const { return x + screenX / zoom; }
+    double toWorldY(int screenY) const { return y + screenY / zoom; }
+    // False if the point lies outside the world
+    bool screenToTile(int screenX, int screenY, int tileSize, int& tileX, int& tileY) const;
+    // Inclusive tile range that intersects the viewport, clamped to the map
+    void visibleTiles(int tileSize, int mapWidth, int mapHeight, int& left, int& top, int& right, int& bottom) const;
+    bool isVisible(const SDL_Rect& world) const;
+
+    // Bumped on every pan/zoom, so cached screen-space output can be invalidated
+    unsigned getRevision() const { return revision; }
+
+private:
+    double x = 0.0, y = 0.0;  // world position of the viewport's top-left corner
+    double zoom = 1.0;
+    int viewportWidth, viewportHeight;
+    int worldWidth, worldHeight;
+    unsigned revision = 0;
+
+    void clamp();
+};
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "game_state.hpp"
+
+// Every accepted command of a match, in order, as a compact byte stream:
+//     SELECT:         type (1 byte) | x (2) | y (2)
+//     MOVE / ATTACK:  type (1 byte) | x (2) | y (2) | stateHash after the turn (8)
+// Commands the rules rejected change nothing and are not stored. Replaying
+// the entries onto the same starting layout must reproduce every hash.
+struct LoggedCommand {
+    Command command;
+    bool endsTurn;
+    uint64_t stateHash;  // only meaningful when endsTurn
+};
+
+struct ReplayResult {
+    bool ok = false;
+    long commands = 0;
+    long turns = 0;
+    long mismatchTurn = -1;  // first turn whose hash differed
+    double seconds = 0.0;
+    uint64_t allocations = 0;  // heap allocations made while stepping
+};
+
+class CommandLog {
+public:
+    // Start a log for a match beginning at `state`
+    void begin(const GameState& state);
+    // Call after state.step(command) returned result
+    void record(const Command& command, const StepResult& result, const GameState& state);
+
+    bool save(const std::string& filename) const;
+    bool load(const std::string& filename);
+
+    // Decodes the entry at `offset` and advances it; false at the end
+    bool next(size_t& offset, LoggedCommand& entry) const;
+    size_t getByteCount() const { return bytes.size(); }
+    long getTurnCount() const { return turns; }
+    uint64_t getInitialHash() const { return initialHash; }
+
+    // Apply every command to `state`, which must hold the starting layout,
+    // checking the state hash after each turn
+    ReplayResult replay(GameState& state) const;
+
+private:
+    int mapWidth = 0;
+    int mapHeight = 0;
+    int unitCount = 0;
+    uint64_t terrainHash = 0;
+    uint64_t initialHash = 0;
+    long turns = 0;
+    std::vector<uint8_t> bytes;
+};
+
+// A match of random clicks, made the way a player would: a random own unit is
+// selected, then a random tile of its ranges clicked (any tile when it has
+// none; blind clicks on a large map would almost never hit). Stops after
+// `turns` turns or when the game is won; `state` is left at the last position.
+CommandLog recordRandomGame(GameState& state, long turns, unsigned seed);
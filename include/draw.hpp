@@ -0,0 +1,16 @@
+#pragma once
+
+#include <SDL.h>
+
+// Thin wrappers around the SDL draw calls that keep a running count, so the
+// number of draw calls per frame can be checked as maps grow.
+int drawTexture(SDL_Renderer* renderer, SDL_Texture* texture, const SDL_Rect* srcRect, const SDL_Rect* dstRect);
+int drawFilledRect(SDL_Renderer* renderer, const SDL_Rect* rect);
+// Many rects of the current draw color in a single call
+int drawFilledRects(SDL_Renderer* renderer, const SDL_Rect* rects, int count);
+
+int getDrawCallCount();
+// Texture draws whose texture differs from the previous texture draw's
+int getTextureSwitchCount();
+// Resets both counts
+void resetDrawCallCount();
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <vector>
+#include "bit_grid.hpp"
+#include "rules.hpp"
+
+// Movement range as a flood fill over bitsets. A unit may enter a tile when
+// its type can pass the terrain and no enemy stands there, i.e.
+//     allowed = passable & ~(occupied & ~friendly)
+// The kernel cuts the (2 * range + 1)^2 window around the unit out of those
+// grids and grows the reached set one move-step per iteration:
+//     reached |= (reached | reached << 1 | reached >> 1 | row above | row below) & allowed
+// so every tile of the frontier is expanded at once, 64 per machine word.
+//
+// The scalar version is a per-tile BFS over the same inputs, used as the
+// reference and when BATTLE_SCALAR_FLOODFILL is defined.
+
+// Appends every tile within `range` steps of (x, y), excluding (x, y) itself,
+// in row-major order
+void floodFillRange(const BitGrid& passable, const BitGrid& occupied, const BitGrid& friendly,
+                    int x, int y, int range, std::vector<Point>& out);
+void floodFillRangeScalar(const BitGrid& passable, const BitGrid& occupied, const BitGrid& friendly,
+                          int x, int y, int range, std::vector<Point>& out);
+
+// floodFillRange() per unit type, with the type's move range. Its window is
+// one word per row, the window size and step count are compile-time
+// constants, and types that can enter any terrain don't read `passable` at
+// all. Defined for every UnitType; forUnitType() picks one at runtime.
+template <UnitType type>
+void floodFillRangeOf(const BitGrid& passable, const BitGrid& occupied, const BitGrid& friendly,
+                      int x, int y, std::vector<Point>& out);
+// The reached window itself, for callers that keep working on bits: bit c
+// of rows[r] is tile (x - range + c, y - range + r), (x, y) included, for
+// the type's move range. `rows` holds 2 * range + 1 words.
+template <UnitType type>
+void floodFillWindowOf(const BitGrid& passable, const BitGrid& occupied, const BitGrid& friendly,
+                       int x, int y, uint64_t* rows);
+
+// Movement ranges of many units in one call: ranges[i] belongs to pool index
+// indices[i], and is left empty for a dead unit. The units are walked one
+// type at a time, so forUnitType() dispatches once per type rather than per unit.
+void floodFillRanges(const UnitPool& units, const std::vector<int>& indices, const Map& map,
+                     const OccupancyGrid& occupancy, std::vector<std::vector<Point>>& ranges);
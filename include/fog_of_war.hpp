@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "bit_grid.hpp"
+#include "game_state.hpp"
+
+// Tiles from (left, top) to (right, bottom), both included; empty when right < left
+struct TileRect {
+    int left = 0, top = 0, right = -1, bottom = -1;
+
+    bool empty() const { return right < left || bottom < top; }
+};
+
+struct FogStats {
+    uint64_t rebuilds = 0;
+    uint64_t updates = 0;
+    uint64_t sightsCast = 0;  // one unit's field of view computed
+};
+
+// What each player's units can see. A unit sees every tile within its sight
+// range (a disc) that a line from its own tile reaches without crossing a
+// mountain; the mountain itself is seen. Each field of view is found by
+// recursive shadowcasting into a small window of 64-bit rows, which is then
+// ORed into the player's BitGrid a word at a time.
+// Units don't block sight and terrain doesn't change during play, so a move
+// or death changes only the mover's or the dead unit's player, and only
+// within its sight of the tiles it left and entered. Those tiles are cleared
+// and re-lit from the units whose sight reaches them.
+// Kept by the front end next to the game state; AI search copies of the
+// state don't carry it.
+class FogOfWar {
+public:
+    // Every player from scratch, e.g. after loading or when terrain changed
+    void rebuild(const GameState& state);
+    // Call after step() moved unit `index`; returns the tiles that may have changed
+    TileRect unitMoved(const GameState& state, int index, Point from, Point to);
+    // Call after a unit of `player` on `tile` left the state
+    TileRect unitRemoved(const GameState& state, int player, Point tile);
+    TileRect unitAdded(const GameState& state, int index);
+
+    bool isVisible(int player, int x, int y) const;
+    // An empty grid for players without units
+    const BitGrid& getVisible(int player) const;
+    // The movement range of `viewer`'s unit `index` as the viewer knows the
+    // board: only their own units and the enemies in sight block it.
+    // `knownOccupied` is scratch, resized to the map when needed.
+    void knownMovementRange(const GameState& state, int viewer, int index, BitGrid& knownOccupied,
+                            std::vector<Point>& out) const;
+
+    const FogStats& getStats() const { return stats; }
+
+private:
+    std::vector<BitGrid> visible;  // indexed by player number
+    BitGrid noTiles;
+    FogStats stats;
+
+    BitGrid& grid(int player);
+    // Clears `rect` of `player`'s grid and lights it again from their units
+    void refresh(const GameState& state, int player, const TileRect& rect);
+    void light(const GameState& state, int index, BitGrid& target, const TileRect& rect);
+};
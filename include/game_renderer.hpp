@@ -0,0 +1,117 @@
+#pragma once
+
+#include <SDL.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "animation_scheduler.hpp"
+#include "arena.hpp"
+#include "asset_cache.hpp"
+#include "bit_grid.hpp"
+#include "camera.hpp"
+#include "fog_of_war.hpp"
+#include "game_state.hpp"
+#include "map_renderer.hpp"
+#include "profiler_overlay.hpp"
+#include "sprite_atlas.hpp"
+#include "threat_map.hpp"
+#include "unit_renderer.hpp"
+
+// Draws a frame of the game through the camera. Only what intersects the
+// viewport is drawn: terrain comes from baked chunks and units are found
+// through the occupancy grid of the visible tiles, so the cost of a frame
+// follows the viewport, not the map.
+// In full mode every frame is redrawn. In dirty-region mode the scene is kept
+// in an offscreen canvas and only tiles marked dirty, or touched by an
+// animation, are repainted before it is presented.
+class GameRenderer {
+public:
+    GameRenderer(SDL_Renderer* renderer, int tileSize, const GameState& state);
+
+    // Sprites come from the packed atlas when atlasFile loads, else from the loose images
+    bool load(AssetCache& assets, const std::string& atlasFile);
+    const SpriteAtlas& getSprites() const { return sprites; }
+    // Re-create render targets after the driver dropped them (SDL_RENDER_TARGETS_RESET)
+    void reset();
+
+    void setDirtyRendering(bool enabled);
+    bool isDirtyRendering() const { return dirtyRendering; }
+
+    // Drawn on top of the scene, outside the dirty-region canvas
+    void setProfilerOverlay(bool visible);
+    bool isProfilerOverlayVisible() const { return overlayVisible; }
+
+    // Draw the board as `viewer` sees it: tiles out of their units' sight are
+    // dimmed and enemy units on them hidden. Without fog, or with viewer 0,
+    // everything is shown.
+    void setFogOfWar(const FogOfWar* fog, int viewer);
+    int getViewer() const { return viewer; }
+    // Heatmap of the damage the other side could deal to each tile, over the
+    // units; nullptr hides it
+    void setThreatOverlay(const ThreatMap* threats, ThreatLayer layer);
+    bool isThreatOverlayVisible() const { return threats != nullptr; }
+
+    Camera& getCamera() { return camera; }
+    const Camera& getCamera() const { return camera; }
+
+    void markTileDirty(int x, int y);
+    void markTilesDirty(const TileRect& rect);
+    void markAllDirty() { fullRedraw = true; }
+    // Mark both the previously drawn and the current selection highlights;
+    // call after setFogOfWar() for the same state
+    void markHighlightsDirty(const GameState& state);
+    bool needsRedraw() const { return fullRedraw || !dirtyList.empty() || camera.getRevision() != drawnCameraRevision; }
+
+    // Repaints what is needed and presents. Returns false when nothing changed.
+    bool renderFrame(const GameState& state, const AnimationScheduler& animations);
+    int getLastDrawCalls() const { return lastDrawCalls; }
+    int getLastTextureSwitches() const { return lastTextureSwitches; }
+
+private:
+    SDL_Renderer* renderer;
+    int tileSize;
+    Camera camera;
+    SpriteAtlas sprites;
+    MapRenderer mapRenderer;
+    UnitRenderer unitRenderer;
+    std::shared_ptr<SDL_Texture> canvas;
+    ProfilerOverlay overlay;
+    bool overlayVisible = false;
+    const FogOfWar* fog = nullptr;
+    int viewer = 0;
+    const ThreatMap* threats = nullptr;
+    ThreatLayer threatLayer = THREAT_NEXT_TURN;
+    int drawnThreatSide = 0;
+    Arena frameArena;  // reset at the start of every frame
+
+    bool dirtyRendering = false;
+    bool fullRedraw = true;
+    unsigned drawnCameraRevision = 0;
+    BitGrid dirtyTiles;
+    std::vector<Point> dirtyList;
+    std::vector<Point> drawnHighlights;
+    // The selected unit's movement range as drawn, see updateShownMovement()
+    std::vector<Point> shownMovement;
+    BitGrid knownOccupied;  // its scratch
+    std::vector<Point> drawnAnimationTiles;
+    std::vector<Point> animationTiles;
+    int lastDrawCalls = 0;
+    int lastTextureSwitches = 0;
+
+    // The side whose view is drawn, and whose enemies' threats
+    int shownSide(const GameState& state) const { return viewer != 0 ? viewer : state.getCurrentPlayer(); }
+    bool isSeen(int x, int y) const { return !fog || viewer == 0 || fog->isVisible(viewer, x, y); }
+    // Whether `player`'s unit on (x, y) is drawn
+    bool showsUnit(int player, int x, int y) const { return player == viewer || isSeen(x, y); }
+    void drawScene(const GameState& state, const AnimationScheduler& animations);
+    void drawFog(int left, int top, int right, int bottom);
+    void drawThreats(const GameState& state, int left, int top, int right, int bottom);
+    void drawTile(const GameState& state, const AnimationScheduler& animations, int x, int y);
+    void drawExplosion(const AnimationScheduler& animations, const ExplosionAnimation& explosion);
+    void drawHighlight(const GameState& state, const Point& point, bool attack);
+    // Under fog, the range the viewer's unit would have if only the enemies in
+    // sight stood on the board, so unseen ones don't show up as holes in it
+    void updateShownMovement(const GameState& state);
+    void rememberHighlights(const GameState& state);
+    SDL_Rect tileRect(int x, int y) const { return { x * tileSize, y * tileSize, tileSize, tileSize }; }
+};
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "map.hpp"
+#include "occupancy_grid.hpp"
+#include "pathfinder.hpp"
+#include "reachability_cache.hpp"
+#include "rules.hpp"
+#include "unit.hpp"
+#include "unit_pool.hpp"
+
+// Commands are expressed in tile coordinates, exactly like a click on the board.
+// MOVE and ATTACK act on the currently selected unit.
+enum CommandType { SELECT, MOVE, ATTACK };
+
+struct Command {
+    CommandType type;
+    int x;
+    int y;
+};
+
+enum StepOutcome { INVALID_COMMAND, SELECTED, MOVED, ATTACKED };
+
+struct StepResult {
+    StepOutcome outcome = INVALID_COMMAND;
+    int unitIndex = -1;      // unit that was selected / acted
+    int targetIndex = -1;    // unit that was attacked, -1 if it was killed
+    Point from = {-1, -1};   // the acting unit's tile before the command
+    Point to = {-1, -1};     // where it moved to, or the tile it attacked
+    int damage = 0;
+    bool killed = false;
+};
+
+// What step() needs to take a MOVE or ATTACK back, so a search can walk the
+// tree on one state instead of copying it per node
+struct StepUndo {
+    StepResult result;
+    int player = 0;
+    int unitIndex = -1;    // the acting unit's index before the command
+    int targetIndex = -1;  // the attacked unit's index before the command
+    // The attacked unit as it was, to put back if it was killed
+    UnitType targetType = INFANTRY;
+    int targetPlayer = 0;
+    int targetHealth = 0;
+    int targetOrientation = 0;
+    UnitHandle targetHandle;
+};
+
+// All game rules, with no dependency on SDL. The front end turns clicks into
+// commands, feeds them to step() and animates whatever the result describes.
+class GameState {
+public:
+    GameState(int width, int height);
+
+    bool loadMap(const std::string& filename);
+    // Fails without adding any unit if one of them stands outside the map or
+    // on a tile another unit, loaded before or from the same file, holds
+    bool loadUnits(const std::string& filename, int player);
+    // Safe mid-game: only ranges near the unit are recomputed, and handles
+    // held elsewhere stay valid. Killed units are removed by step(). Dead or
+    // off-map units aren't added; the handle is then invalid.
+    UnitHandle addUnit(const Unit& unit);
+    bool removeUnit(UnitHandle handle);
+
+    // Resolve a click on tile (x, y) into the command the player meant
+    Command commandForClick(int x, int y) const;
+    StepResult step(const Command& command);
+    // Same, recording into `undo` what undo() needs
+    StepResult step(const Command& command, StepUndo& undo);
+    // Takes back the latest step() recorded into `undo`, including a kill,
+    // and leaves no unit selected. Steps must be undone newest first.
+    void undo(const StepUndo& undo);
+
+    const Map& getMap() const { return *map; }
+    // Terrain setup before play, e.g. by a map generator
+    Map& getMutableMap() {
+        reachability.invalidateAll();
+        return ownMap();
+    }
+    // Unit indices are dense and change when a unit is removed; keep a
+    // UnitHandle to refer to a unit across turns
+    const UnitPool& getUnits() const { return units; }
+    Unit getUnit(int index) const { return units.get(index); }
+    UnitHandle getHandle(int index) const { return units.handleAt(index); }
+    int indexOf(UnitHandle handle) const { return units.indexOf(handle); }
+    const OccupancyGrid& getOccupancy() const { return occupancy; }
+    int getCurrentPlayer() const { return currentPlayer; }
+    int getSelectedIndex() const { return selected; }
+    const std::vector<Point>& getMovementRange() const { return movementRange; }
+    const std::vector<Point>& getAttackRange() const { return attackRange; }
+    // Ranges of any unit, e.g. for hover previews; served from the
+    // reachability cache and recomputed only after a nearby board change
+    const std::vector<Point>& getMovementRangeOf(int index) const { return reachability.movementRange(index, units, *map, occupancy); }
+    const std::vector<Point>& getAttackRangeOf(int index) const { return reachability.attackRange(index, units, *map); }
+    const ReachabilityStats& getReachabilityStats() const { return reachability.getStats(); }
+    // Tiles unit `index` walks from `from` to `to` (both included) within its
+    // move range, avoiding impassable terrain and enemies
+    bool findPath(int index, Point from, Point to, std::vector<Point>& path) const;
+
+    // Index of the alive unit standing on (x, y), or -1
+    int unitAt(int x, int y) const;
+    // Presentation-only; does not touch the occupancy grid
+    void setUnitOrientation(int index, int orientation) { units.setOrientation(index, orientation); }
+    // 0 while both players still have units, otherwise the surviving player
+    int getWinner() const;
+    // Hash of everything the rules depend on: whose turn it is and every
+    // live unit's type, position, owner and health. Selection and
+    // orientation are not part of it.
+    uint64_t stateHash() const;
+
+private:
+    // Terrain never changes during play, so copies of the state (e.g. the
+    // AI's search nodes) share it and only clone it before a write
+    std::shared_ptr<Map> map;
+    UnitPool units;
+    OccupancyGrid occupancy;
+    int currentPlayer = 1;  // Track player turns (1 or 2)
+    int selected = -1;
+    std::vector<Point> movementRange;
+    std::vector<Point> attackRange;
+    mutable ReachabilityCache reachability;
+    mutable Pathfinder pathfinder;
+
+    Map& ownMap();
+    // Drops unit `index` and moves the last unit into its place everywhere
+    // an index is kept
+    void removeAt(int index);
+    // Inverse of removeAt(index), right after it
+    void restoreAt(int index, const StepUndo& undo);
+    bool onMap(int x, int y) const { return x >= 0 && y >= 0 && x < map->getWidth() && y < map->getHeight(); }
+    void reserveSelection(const Unit& unit);
+    void clearSelection();
+    void endTurn();
+};
@@ -1,21 +1,36 @@
-#include <SDL.h>
+#pragma once
+
+#include <cstdint>
 #include <vector>
 #include <string>
-#include "tile.hpp"
+#include "bit_grid.hpp"
+#include "unit_traits.hpp"
 
+// Terrain is one byte per tile in a single row-major array. For every unit
+// type a passability bitset is kept next to it, so pathing code can ask
+// "can this type enter (x, y)" without looking the terrain up in UNIT_TRAITS.
 class Map {
 public:
-    Map(int width, int height, int tileSize);
-    bool loadMap(const std::string& filename, SDL_Renderer* renderer);
-    void render(SDL_Renderer* renderer) const;
+    Map(int width, int height);
+    // Text maps keep the current size; binary (.bmap) maps bring their own
+    bool loadMap(const std::string& filename);
+    bool loadBinaryMap(const std::string& filename);
+    // Text layout, one "G W R M" line per row
+    bool saveMap(const std::string& filename) const;
+    bool saveBinaryMap(const std::string& filename) const;
+    // Text maps: number of lines and tiles on the first line; .bmap: header
+    static bool measureMapFile(const std::string& filename, int& width, int& height);
     int getWidth() const { return width; }
     int getHeight() const { return height; }
-    Tile getTile(int x, int y) const { return tiles[y][x]; }
+
+    TerrainType getTerrain(int x, int y) const { return static_cast<TerrainType>(terrain[y * width + x]); }
+    void setTerrain(int x, int y, TerrainType type);
+    bool isPassable(UnitType unitType, int x, int y) const { return passability[unitType].test(x, y); }
+    const BitGrid& getPassability(UnitType unitType) const { return passability[unitType]; }
+    const uint8_t* getTerrainData() const { return terrain.data(); }
 
 private:
     int width, height;
-    int tileSize;
-    std::vector<std::vector<Tile>> tiles;
-
-    SDL_Texture* loadTexture(const std::string& filePath, SDL_Renderer* renderer);
-};
\ No newline at end of file
+    std::vector<uint8_t> terrain;
+    BitGrid passability[UNIT_TYPE_COUNT];
+};
@@ -0,0 +1,7 @@
+#pragma once
+
+#include "map.hpp"
+
+// Fills the map with random but plausible terrain: grass plains, lakes,
+// mountain ranges and a grid of roads. Same seed, same map.
+void generateTerrain(Map& map, unsigned seed);
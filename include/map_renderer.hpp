@@ -0,0 +1,51 @@
+#pragma once
+
+#include <SDL.h>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include "arena.hpp"
+#include "camera.hpp"
+#include "map.hpp"
+#include "sprite_atlas.hpp"
+
+// Terrain never changes during a game, so it is baked into render-target
+// textures of CHUNK_TILES x CHUNK_TILES tiles. Chunks are baked lazily when
+// they first become visible and the least recently drawn ones are dropped
+// once more than MAX_CHUNKS are resident, so any map size costs the same
+// per frame as the viewport it shows.
+class MapRenderer {
+public:
+    static const int CHUNK_TILES = 16;
+    static const size_t MAX_CHUNKS = 64;
+
+    MapRenderer(int tileSize, const SpriteAtlas& sprites);
+
+    // Drop all baked chunks, e.g. after the driver lost its render targets
+    void invalidate() { chunks.clear(); }
+
+    // Eviction bookkeeping comes from `frameArena`
+    void render(SDL_Renderer* renderer, const Map& map, const Camera& camera, Arena& frameArena);
+    // Terrain of a single tile, e.g. to repair a dirty region
+    void renderTile(SDL_Renderer* renderer, const Map& map, const Camera& camera, int x, int y);
+
+    size_t getResidentChunks() const { return chunks.size(); }
+
+private:
+    struct Chunk {
+        std::shared_ptr<SDL_Texture> texture;
+        uint64_t lastUsed = 0;
+    };
+
+    int tileSize;
+    const SpriteAtlas& sprites;
+    std::unordered_map<int64_t, Chunk> chunks;
+    uint64_t frame = 0;
+    bool targetsUnsupported = false;
+
+    // Baked chunk texture, or nullptr when render targets are unavailable
+    SDL_Texture* chunkTexture(SDL_Renderer* renderer, const Map& map, int chunkX, int chunkY);
+    void drawTiles(SDL_Renderer* renderer, const Map& map, int left, int top, int right, int bottom,
+                   const Camera* camera, int originX, int originY);
+    void evict(Arena& frameArena);
+};
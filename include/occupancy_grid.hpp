@@ -0,0 +1,36 @@
+#pragma once
+
+#include <vector>
+#include "bit_grid.hpp"
+#include "unit_pool.hpp"
+
+// Tile -> unit slot index, so "who stands here" is a single array read
+// instead of a scan over every unit. Alongside it, bitsets of all occupied
+// tiles and of each player's tiles feed the bit-parallel range kernels.
+class OccupancyGrid {
+public:
+    static constexpr int EMPTY = -1;
+
+    OccupancyGrid(int width, int height);
+
+    // Re-index every unit; later units win if two share a tile
+    void rebuild(const UnitPool& units);
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    int at(int x, int y) const { return slots[y * width + x]; }
+    void place(int x, int y, int slot, int player);
+    void clear(int x, int y);
+    void move(int fromX, int fromY, int toX, int toY);
+
+    const BitGrid& getOccupied() const { return occupied; }
+    // Tiles held by `player`; an empty grid for players without units
+    const BitGrid& getPlayerTiles(int player) const;
+
+private:
+    int width, height;
+    std::vector<int> slots;
+    BitGrid occupied;
+    std::vector<BitGrid> playerTiles;  // indexed by player number
+    BitGrid noTiles;
+};
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "map.hpp"
+#include "occupancy_grid.hpp"
+#include "rules.hpp"
+#include "unit_traits.hpp"
+
+// Cost of entering a tile, per unit type and terrain; 0 means impassable
+struct MoveCosts {
+    uint8_t cost[UNIT_TYPE_COUNT][TERRAIN_TYPE_COUNT];
+
+    // 1 wherever isPassable() allows the move, matching calculateMovementRange
+    static MoveCosts uniform();
+};
+
+struct PathQuery {
+    UnitType type;
+    int player;       // enemies of this player block, friends can be walked through
+    Point from;
+    Point to;
+    int maxCost = -1;  // -1 for no limit
+};
+
+// A* over the map with per-terrain costs. All scratch state lives in the
+// pathfinder and only grows, so once warmed up a query does no allocation.
+// With a cost limit the search is confined to the tiles within maxCost
+// steps of the start, which keeps the buffers small on large maps; an
+// unlimited query sizes them to the whole map.
+class Pathfinder {
+public:
+    explicit Pathfinder(const MoveCosts& costs = MoveCosts::uniform());
+    // Copies take the costs but start with cold scratch buffers
+    Pathfinder(const Pathfinder& other) : Pathfinder(other.costs) {}
+    Pathfinder& operator=(const Pathfinder& other) {
+        setCosts(other.costs);
+        return *this;
+    }
+
+    void setCosts(const MoveCosts& newCosts);
+    const MoveCosts& getCosts() const { return costs; }
+
+    // Cheapest path, both ends included, into `path`; false (and an empty
+    // path) if `to` cannot be reached within the limit
+    bool findPath(const PathQuery& query, const Map& map, const OccupancyGrid& occupancy, std::vector<Point>& path);
+    // paths[i] answers queries[i]. Consecutive queries from the same start
+    // share one full Dijkstra search. Returns the number of paths found.
+    int findPaths(const std::vector<PathQuery>& queries, const Map& map, const OccupancyGrid& occupancy,
+                  std::vector<std::vector<Point>>& paths);
+
+    // Tiles taken off the open list by the last search
+    int getLastExpanded() const { return lastExpanded; }
+
+private:
+    struct OpenNode {
+        int estimate;
+        int cost;
+        int index;
+    };
+
+    MoveCosts costs;
+    int minCost[UNIT_TYPE_COUNT];
+
+    // Search window in map coordinates
+    int windowX, windowY, windowWidth, windowHeight;
+    std::vector<int> bestCost;
+    std::vector<int> parent;
+    std::vector<uint32_t> visitMark;
+    uint32_t generation = 0;
+    std::vector<OpenNode> open;
+    int lastExpanded = 0;
+
+    // Fills the search tree from query.from; with `toGoal` it stops as soon
+    // as query.to is settled
+    void search(const PathQuery& query, const Map& map, const OccupancyGrid& occupancy, bool toGoal);
+    bool reconstruct(const PathQuery& query, std::vector<Point>& path) const;
+};
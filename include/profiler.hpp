@@ -0,0 +1,131 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Scoped section timers for the frame loop and the hot rule paths.
+// BATTLE_PROFILE_SCOPE("name") times the rest of the enclosing block while the
+// profiler is enabled at runtime; when BATTLE_PROFILING is not defined the
+// macro expands to nothing. Names must be string literals, they are kept by
+// pointer.
+
+struct ProfileEvent {
+    const char* name;
+    uint64_t startNs;
+    uint64_t durationNs;
+    uint32_t thread;
+};
+
+struct SectionTiming {
+    const char* name;
+    double lastMs;     // total in the last finished frame
+    double averageMs;  // smoothed over recent frames
+    int calls;         // in the last finished frame
+};
+
+struct FrameTimings {
+    int frames = 0;  // in the history window
+    double lastMs = 0.0;
+    double p50Ms = 0.0;
+    double p95Ms = 0.0;
+    double p99Ms = 0.0;
+    double maxMs = 0.0;
+    int drawCalls = 0;
+    uint64_t allocations = 0;  // heap allocations of the last frame on its thread (allocation_counter.hpp)
+};
+
+class Profiler {
+public:
+    static const size_t MAX_THREAD_EVENTS = 1 << 16;  // trace ring buffer of each thread
+    static const size_t FRAME_HISTORY = 240;
+
+    static Profiler& instance();
+    // Monotonic nanoseconds since the profiler was created
+    static uint64_t nowNs();
+
+    void setEnabled(bool value);
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+    // Frame boundaries of the main loop; sections the same thread records in
+    // between are attributed to the frame. Other threads (e.g. AI workers)
+    // only show up in the trace.
+    void beginFrame();
+    void endFrame(int drawCalls);
+    void record(const char* name, uint64_t startNs, uint64_t endNs);
+
+    FrameTimings getFrameTimings() const;
+    std::vector<SectionTiming> getSectionTimings() const;
+    // Into `timings`, reusing its storage
+    void getSectionTimings(std::vector<SectionTiming>& timings) const;
+    // Everything still in the ring buffer, as Chrome's trace event format
+    // (chrome://tracing, Perfetto)
+    bool exportChromeTrace(const std::string& filename) const;
+    void clear();
+
+private:
+    struct Section {
+        const char* name;
+        uint64_t frameNs = 0;
+        int frameCalls = 0;
+        double lastMs = 0.0;
+        double averageMs = 0.0;
+        int lastCalls = 0;
+    };
+
+    // Each thread records into its own ring, so threads never wait on the
+    // frame loop or on each other
+    struct ThreadEvents {
+        mutable std::mutex mutex;  // contended only by export and clear()
+        std::vector<ProfileEvent> events;
+        size_t next = 0;
+        size_t count = 0;
+    };
+    struct ThreadLease;
+
+    std::atomic<bool> enabled{false};
+    std::atomic<uint32_t> frameThread{0};  // the one calling beginFrame()
+    mutable std::mutex mutex;              // guards everything below
+    std::vector<std::unique_ptr<ThreadEvents>> threadEvents;
+    std::vector<ThreadEvents*> spareThreadEvents;  // left by exited threads
+    std::vector<Section> sections;
+    std::vector<double> frameMs;
+    mutable std::vector<double> sortedFrameMs;  // percentile scratch
+    size_t nextFrame = 0;
+    uint64_t frameStartNs = 0;
+    uint64_t frameStartAllocations = 0;
+    int lastDrawCalls = 0;
+    uint64_t lastAllocations = 0;
+
+    Profiler() = default;
+    ThreadEvents& ownEvents();
+    static void push(ThreadEvents& buffer, const ProfileEvent& event);
+};
+
+class ProfileScope {
+public:
+    explicit ProfileScope(const char* name)
+        : name(name), active(Profiler::instance().isEnabled()), startNs(active ? Profiler::nowNs() : 0) {}
+    ~ProfileScope() {
+        if (active) Profiler::instance().record(name, startNs, Profiler::nowNs());
+    }
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    const char* name;
+    bool active;
+    uint64_t startNs;
+};
+
+#ifdef BATTLE_PROFILING
+#define BATTLE_PROFILE_CONCAT_(a, b) a##b
+#define BATTLE_PROFILE_CONCAT(a, b) BATTLE_PROFILE_CONCAT_(a, b)
+#define BATTLE_PROFILE_SCOPE(name) ProfileScope BATTLE_PROFILE_CONCAT(profileScope, __LINE__)(name)
+#else
+#define BATTLE_PROFILE_SCOPE(name) ((void)0)
+#endif
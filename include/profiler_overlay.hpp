@@ -0,0 +1,24 @@
+#pragma once
+
+#include <SDL.h>
+#include <vector>
+#include "arena.hpp"
+#include "profiler.hpp"
+
+// On-screen readout of the profiler: frame time percentiles, draw calls and
+// the time of every profiled section. Text uses a built-in 3x5 pixel font
+// drawn as one batch of rects, so the overlay costs two draw calls. The text
+// of a frame lives in the caller's frame arena.
+class ProfilerOverlay {
+public:
+    static const int PIXEL_SIZE = 2;  // screen pixels per font pixel
+
+    void draw(SDL_Renderer* renderer, Arena& frameArena, int x, int y);
+
+private:
+    std::vector<SDL_Rect> glyphRects;
+    std::vector<const char*> lines;
+    std::vector<SectionTiming> sections;
+
+    void addText(const char* text, int x, int y);
+};
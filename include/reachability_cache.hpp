@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "map.hpp"
+#include "occupancy_grid.hpp"
+#include "rules.hpp"
+#include "unit_pool.hpp"
+
+struct ReachabilityStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;      // first computation for a unit
+    uint64_t recomputes = 0;  // computed again after an invalidation
+    uint64_t invalidations = 0;
+};
+
+// Reachable and attackable tiles of every unit, kept until a board change can
+// affect them. A unit's movement range only depends on its own position and on
+// enemies standing within moveRange steps of it (friendly tiles are always
+// enterable), so a move or death invalidates just the units near the tiles it
+// touched. An attack range only depends on the unit's own position.
+// Entries are indexed like the unit pool and follow its compaction.
+class ReachabilityCache {
+public:
+    ReachabilityCache() = default;
+    ReachabilityCache(const ReachabilityCache& other) = default;
+    ReachabilityCache(ReachabilityCache&& other) = default;
+    // Entry by entry, so resetting a state to a saved one (replays, tests)
+    // keeps the range buffers this cache already grew
+    ReachabilityCache& operator=(const ReachabilityCache& other);
+    ReachabilityCache& operator=(ReachabilityCache&& other) = default;
+
+    const std::vector<Point>& movementRange(int index, const UnitPool& units, const Map& map, const OccupancyGrid& occupancy);
+    const std::vector<Point>& attackRange(int index, const UnitPool& units, const Map& map);
+
+    // Call after the occupancy grid and units reflect the change
+    void unitMoved(int index, const UnitPool& units, Point from, Point to);
+    void unitAdded(int index, const UnitPool& units);
+    // Call before the pool removes the unit; the last unit's entry takes its
+    // place and the removed one's buffers become spare
+    void unitRemoved(int index, const UnitPool& units);
+    // Call after the pool restored unit `index` (UnitPool::restore()); undoes
+    // unitRemoved(index)
+    void unitRestored(int index, const UnitPool& units);
+    // Terrain or unit list changed wholesale
+    void invalidateAll();
+
+    const ReachabilityStats& getStats() const { return stats; }
+    void resetStats() { stats = ReachabilityStats(); }
+
+private:
+    struct Entry {
+        std::vector<Point> movement;
+        std::vector<Point> attack;
+        bool movementValid = false;
+        bool attackValid = false;
+        bool movementComputed = false;
+        bool attackComputed = false;
+    };
+
+    // Indexed like the pool; entries past its end are spare buffers, never valid
+    std::vector<Entry> entries;
+    ReachabilityStats stats;
+
+    Entry& entry(int index);
+    static void forget(Entry& cached);
+    void invalidate(int index, bool attackToo);
+    // Movement ranges of enemies of `mover` that could reach `tile`
+    void invalidateAround(Point tile, int mover, const UnitPool& units);
+};
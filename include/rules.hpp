@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "map.hpp"
+#include "occupancy_grid.hpp"
+#include "unit.hpp"
+#include "unit_pool.hpp"
+
+struct Point {
+    int x;
+    int y;
+};
+
+// Reference version that scans every unit for enemy blockers
+std::vector<Point> calculateMovementRange(const Unit& unit, const Map& map, const UnitPool& units);
+// Same tiles from the occupancy bitsets (see flood_fill.hpp), in row-major
+// order rather than BFS order
+std::vector<Point> calculateMovementRange(const Unit& unit, const Map& map, const OccupancyGrid& occupancy);
+std::vector<Point> calculateAttackRange(const Unit& unit, const Map& map);
+// The same, replacing the contents of `out`. Each is specialized per unit
+// type (see forUnitType()) and keeps its scratch on the stack or in the
+// thread's scratch arena, so once `out` has grown they don't allocate.
+void calculateMovementRange(const Unit& unit, const Map& map, const UnitPool& units, std::vector<Point>& out);
+void calculateMovementRange(const Unit& unit, const Map& map, const OccupancyGrid& occupancy, std::vector<Point>& out);
+void calculateAttackRange(const Unit& unit, const Map& map, std::vector<Point>& out);
+// Text layouts ("I 3 1 1" per line) belong to `player`; binary .bunits
+// layouts carry their own player per unit and ignore it
+bool loadUnits(const std::string& filename, int player, std::vector<Unit>& units);
+bool loadBinaryUnits(const std::string& filename, std::vector<Unit>& units);
+bool saveBinaryUnits(const std::vector<Unit>& units, const std::string& filename);
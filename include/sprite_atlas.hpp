@@ -0,0 +1,42 @@
+#pragma once
+
+#include <SDL.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "asset_cache.hpp"
+#include "camera.hpp"
+#include "sprite_catalog.hpp"
+
+struct Sprite {
+    SDL_Texture* texture = nullptr;  // nullptr: nothing to draw
+    SDL_Rect source = {0, 0, 0, 0};
+    SDL_Rect box = {0, 0, 0, 0};     // destination, relative to the tile's top-left in world pixels
+};
+
+// Every sprite of the catalogue, ready to draw. Packed, they come from the
+// pages atlas_packer wrote: usually a single texture, pre-scaled so sprites
+// are copied 1:1 at zoom 1. Loose, every source sheet is its own texture and
+// frames are scaled while drawing, as a fallback when no atlas was built.
+class SpriteAtlas {
+public:
+    // False when the layout is missing, broken or packed for another tile size
+    bool loadPacked(const std::string& layoutFile, int tileSize, AssetCache& assets);
+    bool loadLoose(int tileSize, AssetCache& assets);
+    bool isPacked() const { return packed; }
+    size_t getTextureCount() const { return textures.size(); }
+
+    const Sprite& get(int sprite) const { return sprites[sprite]; }
+    // With the sprite's tile at world pixel (x, y)
+    void draw(SDL_Renderer* renderer, const Camera& camera, int sprite, int x, int y) const;
+    // Same without a camera, in the render target's own pixels
+    void drawLocal(SDL_Renderer* renderer, int sprite, int x, int y) const;
+
+    // Images loadPacked or loadLoose will ask the cache for, for AssetCache::preload
+    static std::vector<std::string> imagePaths(const std::string& layoutFile, int tileSize);
+
+private:
+    std::vector<std::shared_ptr<SDL_Texture>> textures;
+    std::vector<Sprite> sprites;
+    bool packed = false;
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+#include "tile.hpp"
+#include "unit.hpp"
+
+// Every image the renderers draw, numbered densely so they index arrays rather
+// than look names up. A sprite is a rect of a source image plus the box,
+// relative to the top-left of its tile, that it is drawn into; the atlas
+// packer pre-scales each one to its box.
+
+const int UNIT_ORIENTATIONS = 4;
+const int UNIT_FRAME_SIZE = 56;
+const int EXPLOSION_FRAMES = 15;
+const int EXPLOSION_FRAME_WIDTH = 240;
+const int EXPLOSION_FRAME_HEIGHT = 140;
+
+const int UNIT_SPRITES_BEGIN = TERRAIN_TYPE_COUNT;
+const int EXPLOSION_SPRITES_BEGIN = UNIT_SPRITES_BEGIN + UNIT_TYPE_COUNT * 2 * UNIT_ORIENTATIONS;
+const int SPRITE_COUNT = EXPLOSION_SPRITES_BEGIN + EXPLOSION_FRAMES;
+
+inline int terrainSprite(TerrainType type) {
+    return type;
+}
+
+// Players other than 1 use the second player's colours
+inline int unitSprite(UnitType type, int player, int orientation) {
+    return UNIT_SPRITES_BEGIN + (type * 2 + (player == 1 ? 0 : 1)) * UNIT_ORIENTATIONS + orientation;
+}
+
+inline int explosionSprite(int frame) {
+    return EXPLOSION_SPRITES_BEGIN + frame;
+}
+
+struct SpriteRect {
+    int x, y, w, h;
+};
+
+struct SpriteSource {
+    const char* path;
+    SpriteRect source;  // w == 0 takes the whole image
+    SpriteRect box;     // at the given tile size
+};
+
+SpriteSource spriteSource(int sprite, int tileSize);
+// Readable id for atlas metadata, e.g. "unit/tank_p2/3"
+std::string spriteName(int sprite);
+
+const char* terrainImagePath(TerrainType type);
+const char* unitSheetPath(UnitType type, int player);
+const char* explosionSheetPath();
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of workers, each with its own task deque. A worker pops the
+// newest task from its own deque and, when that runs dry, steals the oldest
+// task from another worker, so uneven tasks (e.g. search subtrees) balance
+// out without a single contended queue.
+class ThreadPool {
+public:
+    // 0 threads means one per hardware thread
+    explicit ThreadPool(unsigned threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned getThreadCount() const { return static_cast<unsigned>(workers.size()); }
+
+    // Tasks submitted from a worker go to its own deque, others are spread
+    // round-robin
+    void submit(std::function<void()> task);
+    // Blocks until `pending` drops to zero, running queued tasks meanwhile so
+    // a worker can wait on tasks it spawned itself
+    void wait(const std::atomic<int>& pending);
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<unsigned> nextQueue{0};
+    std::atomic<int> queued{0};
+    std::atomic<bool> stopping{false};
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+
+    void workerLoop(unsigned index);
+    // Runs one task from queue `self` or stolen from another; false if
+    // every queue was empty
+    bool runOne(unsigned self);
+    bool popOwn(unsigned index, std::function<void()>& task);
+    bool steal(unsigned thief, std::function<void()>& task);
+};
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "fog_of_war.hpp"
+#include "game_state.hpp"
+
+// A turn is a move or an attack, so what a side threatens comes in two horizons
+enum ThreatLayer {
+    THREAT_NEXT_TURN,    // attacks from where the units stand
+    THREAT_AFTER_MOVE,   // attacks after moving first, i.e. over two of their turns
+};
+
+const int THREAT_LAYER_COUNT = 2;
+
+struct ThreatStats {
+    uint64_t rebuilds = 0;
+    uint64_t updates = 0;
+    uint64_t unitsRecomputed = 0;  // after-move reach recomputed for one unit
+};
+
+// Damage each player's units could deal to every tile, summed over units, for
+// the whole board at once. Layers are one uint16_t per tile, row-major.
+// Next turn: a box filter of each attack range over a grid holding every
+// unit's damage on its tile, done as shifted adds of whole rows.
+// After a move: each unit's movement flood fill (flood_fill.hpp) dilated by
+// its attack range with word shifts, then added in.
+// Updates are incremental. A unit's next-turn square moves with it; its
+// after-move reach also depends on the enemies near it, so a move, death or
+// spawn redoes the reach of the unit and of the enemies whose movement the
+// tiles it touched can change, subtracting what each had added before.
+// Kept by the front end next to the game state, like FogOfWar.
+class ThreatMap {
+public:
+    ThreatMap();
+
+    void rebuild(const GameState& state);
+    // Counts other players' units only while `viewer` sees their tile, so the
+    // layers don't give away hidden enemies; no fog or viewer 0 counts every
+    // unit. Call again whenever the fog changed; returns the tiles that did.
+    TileRect setSight(const FogOfWar* fog, int viewer);
+    // Call after step() moved unit `index`; returns the tiles that may have changed
+    TileRect unitMoved(const GameState& state, int index, Point from, Point to);
+    // Call after the unit left the state, with the handle it had
+    TileRect unitRemoved(const GameState& state, UnitHandle handle);
+    TileRect unitAdded(const GameState& state, int index);
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    // Damage `player`'s units could deal to (x, y)
+    int getDamage(ThreatLayer layer, int player, int x, int y) const;
+    // Row y of a layer; nullptr for players without units
+    const uint16_t* row(ThreatLayer layer, int player, int y) const;
+
+    const ThreatStats& getStats() const { return stats; }
+
+private:
+    // What one unit added to the layers, by pool slot
+    struct Contribution {
+        bool live = false;
+        bool shown = false;  // added to the layers, see setSight()
+        int player = 0;
+        int x = 0, y = 0;
+        int damage = 0;
+        int attackRange = 0;
+        int reach = 0;  // move + attack range: the after-move window spans 2 * reach + 1 tiles
+        int originX = 0, originY = 0;
+    };
+
+    int width = 0, height = 0;
+    int maxMove;       // over all unit types
+    int maxReach;
+    int windowRows;    // 2 * maxReach + 1, the stride of reachRows
+    std::vector<std::vector<uint16_t>> layers[THREAT_LAYER_COUNT];  // by player number
+    std::vector<Contribution> contributions;
+    std::vector<uint64_t> reachRows;  // windowRows words per slot
+    const FogOfWar* fog = nullptr;
+    int viewer = 0;
+    ThreatStats stats;
+
+    bool isShown(const Contribution& unit) const;
+    std::vector<uint16_t>& layer(ThreatLayer threat, int player);
+    void addSquare(const Contribution& unit, int sign);
+    void addReach(uint32_t slot, int sign);
+    void computeReach(const GameState& state, int index, uint32_t slot);
+    // Redoes the after-move reach of `player`'s enemies that could walk onto `tile`
+    void refreshEnemiesAround(const GameState& state, int player, Point tile, TileRect& changed);
+    void place(const GameState& state, int index, TileRect& changed);
+    void unplace(uint32_t slot, TileRect& changed);
+};
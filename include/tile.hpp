@@ -1,9 +1,5 @@
 #pragma once
 
-#include <iostream>
-#include <SDL.h>
-#include <SDL_image.h>
-
 enum TerrainType {
     GRASS,
     WATER,
@@ -11,14 +7,4 @@ enum TerrainType {
     MOUNTAIN
 };
 
-struct Tile {
-    TerrainType type;
-    bool passableByTank;
-    bool passableByInfantry;
-    bool passableByBoat;
-    bool passableByHelicopter;
-    SDL_Texture* texture;
-
-    Tile(TerrainType type = GRASS, SDL_Texture* texture = nullptr);
-    void render(SDL_Renderer* renderer, int x, int y, int tileSize) const;
-};
+const int TERRAIN_TYPE_COUNT = 4;
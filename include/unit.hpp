@@ -1,24 +1,20 @@
 #pragma once
 
-#include <SDL.h>
-
-enum UnitType { INFANTRY, TANK, BOAT, HELICOPTER };
+#include "unit_traits.hpp"
 
 class Unit {
 public:
-    Unit(UnitType type, int x, int y, int player, int orientation, SDL_Texture* texture);
-
-    void render(SDL_Renderer* renderer, int tileSize);
-    
-    bool animateMovement(int targetX, int targetY, int tileSize);
+    Unit(UnitType type, int x, int y, int player, int orientation);
 
     int getX() const { return x; }
     int getY() const { return y; }
     int getPlayer() const { return player; }
+    int getOrientation() const { return orientation; }
     int getHealth() const { return health; }
-    int getMoveRange() const { return moveRange; }
-    int getAttackDamage() const { return attackDamage; }
-    int getAttackRange() const { return attackRange; }
+    int getMoveRange() const { return UNIT_TRAITS[type].moveRange; }
+    int getAttackDamage() const { return UNIT_TRAITS[type].attackDamage; }
+    int getAttackRange() const { return UNIT_TRAITS[type].attackRange; }
+    int getSightRange() const { return UNIT_TRAITS[type].sightRange; }
     UnitType getType() const { return type; }
 
     void takeDamage(int damage) { health -= damage; }
@@ -26,6 +22,7 @@ public:
     bool inAttackRange(int targetX, int targetY) const;
 
     void setPosition(int x, int y);
+    void setOrientation(int newOrientation) { orientation = newOrientation; }
 
 private:
     UnitType type;
@@ -33,9 +30,4 @@ private:
     int player;
     int orientation;
     int health;
-    int moveRange;
-    int attackDamage;
-    int attackRange;
-    SDL_Texture* texture;
 };
-
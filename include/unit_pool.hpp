@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "unit.hpp"
+
+// Refers to a unit for as long as it lives. Indices into the pool shift when
+// other units are removed, a handle doesn't; once its unit is removed the
+// handle is stale and every lookup with it fails, even if the slot is reused.
+struct UnitHandle {
+    static constexpr uint32_t INVALID_SLOT = 0xffffffffu;
+
+    uint32_t slot = INVALID_SLOT;
+    uint32_t generation = 0;
+
+    bool operator==(const UnitHandle& other) const { return slot == other.slot && generation == other.generation; }
+    bool operator!=(const UnitHandle& other) const { return !(*this == other); }
+};
+
+// Live units only, packed at indices 0..size()-1 with each hot field in its
+// own array, so rules loops touch just the fields they read and never skip
+// dead units. remove() moves the last unit into the hole: indices are only
+// stable until the next removal, handles until their own unit is removed.
+class UnitPool {
+public:
+    UnitHandle spawn(const Unit& unit);
+    // The unit at size() - 1 takes over `index`, unless it was the one removed
+    void remove(int index);
+    // Inverse of the latest remove(): `unit` goes back to `index` under its
+    // old handle and the unit moved into the hole goes back to the end
+    void restore(int index, const Unit& unit, UnitHandle handle);
+    void clear();
+
+    int size() const { return static_cast<int>(xs.size()); }
+    bool empty() const { return xs.empty(); }
+
+    // Index of the handle's unit, or -1 once it was removed
+    int indexOf(UnitHandle handle) const;
+    bool contains(UnitHandle handle) const { return indexOf(handle) != -1; }
+    UnitHandle handleAt(int index) const { return {denseSlots[index], slotGenerations[denseSlots[index]]}; }
+
+    int getX(int index) const { return xs[index]; }
+    int getY(int index) const { return ys[index]; }
+    int getPlayer(int index) const { return players[index]; }
+    int getHealth(int index) const { return healths[index]; }
+    UnitType getType(int index) const { return types[index]; }
+    int getOrientation(int index) const { return orientations[index]; }
+    // Type stats, from UNIT_TRAITS
+    int getMoveRange(int index) const { return UNIT_TRAITS[types[index]].moveRange; }
+    int getAttackDamage(int index) const { return UNIT_TRAITS[types[index]].attackDamage; }
+    int getAttackRange(int index) const { return UNIT_TRAITS[types[index]].attackRange; }
+    int getSightRange(int index) const { return UNIT_TRAITS[types[index]].sightRange; }
+
+    void setPosition(int index, int x, int y) {
+        xs[index] = x;
+        ys[index] = y;
+    }
+    void setOrientation(int index, int orientation) { orientations[index] = orientation; }
+    void takeDamage(int index, int damage) { healths[index] -= damage; }
+
+    // The whole unit as a value, for the rules that take a Unit
+    Unit get(int index) const;
+    std::vector<Unit> toVector() const;
+
+private:
+    // Hot fields, by dense index
+    std::vector<int> xs;
+    std::vector<int> ys;
+    std::vector<int> players;
+    std::vector<int> healths;
+    std::vector<UnitType> types;
+    // Cold: only the renderer reads it
+    std::vector<int> orientations;
+
+    std::vector<uint32_t> denseSlots;        // dense index -> slot
+    std::vector<int> slotIndices;            // slot -> dense index, -1 when free
+    std::vector<uint32_t> slotGenerations;   // bumped when a slot's unit is removed
+    std::vector<uint32_t> freeSlots;
+
+    // Appends the unit under `slot`
+    void spawnInto(uint32_t slot, const Unit& unit);
+};
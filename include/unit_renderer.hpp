@@ -0,0 +1,20 @@
+#pragma once
+
+#include <SDL.h>
+#include "camera.hpp"
+#include "sprite_atlas.hpp"
+#include "unit.hpp"
+
+class UnitRenderer {
+public:
+    UnitRenderer(int tileSize, const SpriteAtlas& sprites);
+
+    // Draws the unit at tile (x, y), which may differ from its logical position while animating
+    void render(SDL_Renderer* renderer, const Camera& camera, const Unit& unit, int x, int y) const;
+    // Same, at a world pixel position (top-left of the tile box)
+    void renderAt(SDL_Renderer* renderer, const Camera& camera, const Unit& unit, int pixelX, int pixelY) const;
+
+private:
+    int tileSize;
+    const SpriteAtlas& sprites;
+};
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <type_traits>
+#include "tile.hpp"
+
+enum UnitType { INFANTRY, TANK, BOAT, HELICOPTER };
+
+const int UNIT_TYPE_COUNT = 4;
+
+// Terrain types as bits, for UnitTraits::terrain
+constexpr unsigned terrainBit(TerrainType terrain) { return 1u << terrain; }
+constexpr unsigned ALL_TERRAIN = (1u << TERRAIN_TYPE_COUNT) - 1;
+
+// Everything a unit type is, fixed at compile time. The rules read these
+// straight from the table, and kernels templated on the type fold them into
+// constants (see forUnitType()).
+struct UnitTraits {
+    int health;
+    int attackDamage;
+    int moveRange;
+    int attackRange;
+    int sightRange;
+    unsigned terrain;  // terrainBit()s the type can enter
+};
+
+constexpr UnitTraits UNIT_TRAITS[UNIT_TYPE_COUNT] = {
+    // health, damage, move, attack, sight, terrain
+    {50, 10, 2, 1, 3, terrainBit(GRASS) | terrainBit(ROAD) | terrainBit(MOUNTAIN)},  // INFANTRY
+    {150, 20, 4, 2, 3, terrainBit(GRASS) | terrainBit(ROAD)},                        // TANK
+    {100, 10, 2, 1, 4, terrainBit(WATER)},                                           // BOAT
+    {100, 20, 6, 2, 5, ALL_TERRAIN},                                                 // HELICOPTER
+};
+
+struct TerrainTraits {
+    bool blocksSight;
+};
+
+constexpr TerrainTraits TERRAIN_TRAITS[TERRAIN_TYPE_COUNT] = {
+    {false},  // GRASS
+    {false},  // WATER
+    {false},  // ROAD
+    {true},   // MOUNTAIN
+};
+
+// Single source of truth for which unit types can enter which terrain
+constexpr bool isPassable(TerrainType terrain, UnitType unitType) {
+    return (UNIT_TRAITS[unitType].terrain & terrainBit(terrain)) != 0;
+}
+
+constexpr int maxUnitTrait(int UnitTraits::*trait) {
+    int most = 0;
+    for (const UnitTraits& traits : UNIT_TRAITS) {
+        most = traits.*trait > most ? traits.*trait : most;
+    }
+    return most;
+}
+
+// Largest of each range over all types, in tiles
+constexpr int MAX_MOVE_RANGE = maxUnitTrait(&UnitTraits::moveRange);
+constexpr int MAX_ATTACK_RANGE = maxUnitTrait(&UnitTraits::attackRange);
+constexpr int MAX_SIGHT_RANGE = maxUnitTrait(&UnitTraits::sightRange);
+
+// Calls kernel(std::integral_constant<UnitType, type>()), so a kernel
+// templated on the type is chosen once per call rather than switching on the
+// type inside its loops:
+//     forUnitType(unit.getType(), [&](auto type) { kernel<decltype(type)::value>(...); });
+template <typename Kernel>
+decltype(auto) forUnitType(UnitType type, Kernel&& kernel) {
+    switch (type) {
+        case TANK: return kernel(std::integral_constant<UnitType, TANK>());
+        case BOAT: return kernel(std::integral_constant<UnitType, BOAT>());
+        case HELICOPTER: return kernel(std::integral_constant<UnitType, HELICOPTER>());
+        case INFANTRY: break;
+    }
+    return kernel(std::integral_constant<UnitType, INFANTRY>());
+}
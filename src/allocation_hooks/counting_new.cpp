@@ -0,0 +1,89 @@
+#include "allocation_counter.hpp"
+#include <cstdlib>
+#include <new>
+
+// Linked into the benchmarks, replay and battle_tests only, never into
+// battle_core: replacing the global operator new is a decision for the
+// executable, not for a library
+
+namespace {
+
+// Set during static initialization, so allocationCountingEnabled() is true
+// from main() on
+[[maybe_unused]] const bool installed = (enableAllocationCounting(), true);
+
+void* countedAllocate(std::size_t size) {
+    AllocationStats& counters = threadAllocationCounters();
+    counters.allocations++;
+    counters.bytes += size;
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void* countedAllocateAligned(std::size_t size, std::align_val_t alignment) {
+    AllocationStats& counters = threadAllocationCounters();
+    counters.allocations++;
+    counters.bytes += size;
+    std::size_t align = static_cast<std::size_t>(alignment);
+    // aligned_alloc wants a multiple of the alignment
+    std::size_t rounded = (size + align - 1) / align * align;
+    return std::aligned_alloc(align, rounded == 0 ? align : rounded);
+}
+
+void countedFree(void* pointer) {
+    if (!pointer) return;
+    threadAllocationCounters().frees++;
+    std::free(pointer);
+}
+
+}
+
+// Every form is replaced, not just the ones the others default to, so no
+// pointer ever crosses over to a runtime that replaces the rest (sanitizers)
+void* operator new(std::size_t size) {
+    void* pointer = countedAllocate(size);
+    if (!pointer) throw std::bad_alloc();
+    return pointer;
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return countedAllocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return countedAllocate(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    void* pointer = countedAllocateAligned(size, alignment);
+    if (!pointer) throw std::bad_alloc();
+    return pointer;
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return operator new(size, alignment);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return countedAllocateAligned(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return countedAllocateAligned(size, alignment);
+}
+
+void operator delete(void* pointer) noexcept { countedFree(pointer); }
+void operator delete[](void* pointer) noexcept { countedFree(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { countedFree(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept { countedFree(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { countedFree(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { countedFree(pointer); }
+void operator delete(void* pointer, std::align_val_t) noexcept { countedFree(pointer); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { countedFree(pointer); }
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept { countedFree(pointer); }
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept { countedFree(pointer); }
+void operator delete(void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { countedFree(pointer); }
+void operator delete[](void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { countedFree(pointer); }
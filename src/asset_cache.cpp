@@ -0,0 +1,136 @@
+#include "asset_cache.hpp"
+#include <SDL_image.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+double millisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+}
+
+AssetCache::AssetCache(SDL_Renderer* renderer)
+    : renderer(renderer) {}
+
+AssetCache::~AssetCache() {
+    clear();
+}
+
+AssetCache::Decoded AssetCache::decode(const std::string& path) {
+    Decoded decoded;
+    decoded.surface = IMG_Load(path.c_str());
+    if (!decoded.surface) decoded.error = IMG_GetError();
+    return decoded;
+}
+
+std::shared_ptr<SDL_Texture> AssetCache::upload(const std::string& path, const Decoded& decoded) {
+    SDL_Surface* surface = decoded.surface;
+    if (!surface) {
+        std::cerr << "Failed to load texture: " << path << ": " << decoded.error << std::endl;
+        return nullptr;
+    }
+    auto start = std::chrono::steady_clock::now();
+    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
+    stats.decodes++;
+    stats.decodedBytes += static_cast<size_t>(surface->pitch) * surface->h;
+    SDL_FreeSurface(surface);
+    stats.uploadMs += millisecondsSince(start);
+    if (!texture) {
+        std::cerr << "Failed to create texture: " << path << ": " << SDL_GetError() << std::endl;
+        return nullptr;
+    }
+    std::shared_ptr<SDL_Texture> shared(texture, SDL_DestroyTexture);
+    textures[path] = shared;
+    return shared;
+}
+
+void AssetCache::preload(const std::vector<std::string>& paths, unsigned threads) {
+    std::vector<std::string> pending;
+    for (const std::string& path : paths) {
+        if (!textures.count(path) && std::find(pending.begin(), pending.end(), path) == pending.end()) {
+            pending.push_back(path);
+        }
+    }
+    if (pending.empty()) return;
+
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min<unsigned>(threads, static_cast<unsigned>(pending.size()));
+
+    // Decoding only touches surfaces, so it can run off the render thread
+    auto start = std::chrono::steady_clock::now();
+    std::vector<Decoded> decoded(pending.size());
+    std::atomic<size_t> next{0};
+    std::vector<std::thread> workers;
+    for (unsigned i = 0; i < threads; i++) {
+        workers.emplace_back([&]() {
+            for (size_t job = next++; job < pending.size(); job = next++) {
+                decoded[job] = decode(pending[job]);
+            }
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    stats.decodeMs += millisecondsSince(start);
+
+    for (size_t i = 0; i < pending.size(); i++) {
+        upload(pending[i], decoded[i]);
+    }
+}
+
+std::shared_ptr<SDL_Texture> AssetCache::getTexture(const std::string& path) {
+    stats.requests++;
+    auto it = textures.find(path);
+    if (it != textures.end()) {
+        stats.cacheHits++;
+        return it->second;
+    }
+    auto start = std::chrono::steady_clock::now();
+    Decoded decoded = decode(path);
+    stats.decodeMs += millisecondsSince(start);
+    return upload(path, decoded);
+}
+
+void AssetCache::releaseUnused() {
+    for (auto it = textures.begin(); it != textures.end();) {
+        if (it->second.use_count() == 1) {
+            it = textures.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void AssetCache::clear() {
+    textures.clear();
+}
+
+void AssetCache::printStats(double startupMs) const {
+    std::cout << "Startup: " << startupMs << " ms, "
+              << stats.decodes << " textures decoded for " << stats.requests << " requests ("
+              << stats.cacheHits << " cache hits), "
+              << stats.decodedBytes / 1024 << " KiB of pixels, decode " << stats.decodeMs << " ms, upload "
+              << stats.uploadMs << " ms, peak RSS " << peakResidentBytes() / (1024 * 1024) << " MiB" << std::endl;
+}
+
+size_t peakResidentBytes() {
+#ifdef _WIN32
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+    return static_cast<size_t>(usage.ru_maxrss);          // bytes on macOS
+#else
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;   // kilobytes on Linux
+#endif
+#endif
+}
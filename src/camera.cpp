@@ -0,0 +1,71 @@
+#include "camera.hpp"
+#include <algorithm>
+#include <cmath>
+
+Camera::Camera(int viewportWidth, int viewportHeight, int worldWidth, int worldHeight)
+    : viewportWidth(viewportWidth), viewportHeight(viewportHeight), worldWidth(worldWidth), worldHeight(worldHeight) {}
+
+void Camera::setViewport(int width, int height) {
+    viewportWidth = width;
+    viewportHeight = height;
+    clamp();
+}
+
+void Camera::pan(double screenDeltaX, double screenDeltaY) {
+    x += screenDeltaX / zoom;
+    y += screenDeltaY / zoom;
+    clamp();
+}
+
+void Camera::zoomAt(double factor, int screenX, int screenY) {
+    double worldX = toWorldX(screenX);
+    double worldY = toWorldY(screenY);
+    zoom = std::clamp(zoom * factor, MIN_ZOOM, MAX_ZOOM);
+    x = worldX - screenX / zoom;
+    y = worldY - screenY / zoom;
+    clamp();
+}
+
+void Camera::centerOn(double worldX, double worldY) {
+    x = worldX - viewportWidth / (2.0 * zoom);
+    y = worldY - viewportHeight / (2.0 * zoom);
+    clamp();
+}
+
+void Camera::clamp() {
+    // Keep the map filling the view; center it when it is smaller than the view
+    double viewWidth = viewportWidth / zoom;
+    double viewHeight = viewportHeight / zoom;
+    x = worldWidth > viewWidth ? std::clamp(x, 0.0, worldWidth - viewWidth) : (worldWidth - viewWidth) / 2.0;
+    y = worldHeight > viewHeight ? std::clamp(y, 0.0, worldHeight - viewHeight) : (worldHeight - viewHeight) / 2.0;
+    revision++;
+}
+
+SDL_Rect Camera::toScreen(const SDL_Rect& world) const {
+    int left = static_cast<int>(std::lround((world.x - x) * zoom));
+    int top = static_cast<int>(std::lround((world.y - y) * zoom));
+    int right = static_cast<int>(std::lround((world.x + world.w - x) * zoom));
+    int bottom = static_cast<int>(std::lround((world.y + world.h - y) * zoom));
+    return { left, top, right - left, bottom - top };
+}
+
+bool Camera::screenToTile(int screenX, int screenY, int tileSize, int& tileX, int& tileY) const {
+    double worldX = toWorldX(screenX);
+    double worldY = toWorldY(screenY);
+    if (worldX < 0 || worldY < 0 || worldX >= worldWidth || worldY >= worldHeight) return false;
+    tileX = static_cast<int>(worldX) / tileSize;
+    tileY = static_cast<int>(worldY) / tileSize;
+    return true;
+}
+
+void Camera::visibleTiles(int tileSize, int mapWidth, int mapHeight, int& left, int& top, int& right, int& bottom) const {
+    left = std::max(0, static_cast<int>(std::floor(x / tileSize)));
+    top = std::max(0, static_cast<int>(std::floor(y / tileSize)));
+    right = std::min(mapWidth - 1, static_cast<int>(std::floor((x + viewportWidth / zoom) / tileSize)));
+    bottom = std::min(mapHeight - 1, static_cast<int>(std::floor((y + viewportHeight / zoom) / tileSize)));
+}
+
+bool Camera::isVisible(const SDL_Rect& world) const {
+    return world.x + world.w > x && world.y + world.h > y &&
+           world.x < x + viewportWidth / zoom && world.y < y + viewportHeight / zoom;
+}
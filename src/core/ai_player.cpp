@@ -0,0 +1,358 @@
+#include "ai_player.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <mutex>
+#include <numeric>
+#include "profiler.hpp"
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+const int INFINITE_SCORE = 1 << 30;
+// A win at ply p scores WIN_SCORE - p, so quicker wins are preferred
+const int WIN_SCORE = 1 << 24;
+const int MAX_WIN_PLY = 1024;
+const uint64_t NODES_PER_CLOCK_CHECK = 1024;
+
+// State shared by every task of one chooseAction() call
+struct Search {
+    const GameState& root;
+    TranspositionTable& table;
+    Clock::time_point deadline;
+    bool mayStop;  // the first iteration always finishes
+    std::atomic<bool> stopped{false};
+    std::atomic<uint64_t> nodes{0};
+
+    Search(const GameState& root, TranspositionTable& table, Clock::time_point deadline)
+        : root(root), table(table), deadline(deadline), mayStop(false) {}
+
+    // Copies of the root for tasks to search on; every task undoes all it
+    // stepped, so a released copy is the root again. Only as many copies as
+    // tasks ever ran at once get made.
+    std::unique_ptr<GameState> acquireState() {
+        {
+            std::lock_guard<std::mutex> lock(statesMutex);
+            if (!spareStates.empty()) {
+                std::unique_ptr<GameState> state = std::move(spareStates.back());
+                spareStates.pop_back();
+                return state;
+            }
+        }
+        return std::make_unique<GameState>(root);
+    }
+
+    void releaseState(std::unique_ptr<GameState> state) {
+        std::lock_guard<std::mutex> lock(statesMutex);
+        spareStates.push_back(std::move(state));
+    }
+
+private:
+    std::mutex statesMutex;
+    std::vector<std::unique_ptr<GameState>> spareStates;
+};
+
+// Per-task scratch; one action list per ply so recursion doesn't allocate
+// once the lists have grown
+struct Worker {
+    Search& search;
+    uint64_t nodes = 0;
+    std::vector<std::vector<AiAction>> actions;
+    std::vector<std::vector<int>> order;
+
+    Worker(Search& search, int maxDepth) : search(search), actions(maxDepth + 1), order(maxDepth + 1) {}
+    ~Worker() { search.nodes += nodes; }
+};
+
+bool isWin(int score) {
+    return std::abs(score) > WIN_SCORE - MAX_WIN_PLY;
+}
+
+// Wins are stored relative to the node, so they stay right wherever the
+// position recurs in the tree
+int toTable(int score, int ply) {
+    if (!isWin(score)) return score;
+    return score > 0 ? score + ply : score - ply;
+}
+
+int fromTable(int score, int ply) {
+    if (!isWin(score)) return score;
+    return score > 0 ? score - ply : score + ply;
+}
+
+int unitValue(UnitType type) {
+    const UnitTraits& stats = UNIT_TRAITS[type];
+    return stats.attackDamage * (1 + stats.attackRange) + 2 * stats.moveRange;
+}
+
+int negamax(Worker& worker, GameState& state, int depth, int alpha, int beta, int ply) {
+    Search& search = worker.search;
+    if (++worker.nodes % NODES_PER_CLOCK_CHECK == 0 && search.mayStop && Clock::now() >= search.deadline) {
+        search.stopped = true;
+    }
+    if (search.stopped) return 0;
+
+    int winner = state.getWinner();
+    if (winner != 0) {
+        return winner == state.getCurrentPlayer() ? WIN_SCORE - ply : -(WIN_SCORE - ply);
+    }
+    if (depth == 0) return AiPlayer::evaluate(state);
+
+    uint64_t key = state.stateHash();
+    TranspositionTable::Entry entry;
+    int tableMove = -1;
+    if (search.table.probe(key, entry)) {
+        tableMove = entry.move;
+        if (entry.depth >= depth) {
+            int score = fromTable(entry.score, ply);
+            if (entry.bound == TranspositionTable::EXACT) return score;
+            if (entry.bound == TranspositionTable::LOWER && score >= beta) return score;
+            if (entry.bound == TranspositionTable::UPPER && score <= alpha) return score;
+        }
+    }
+
+    std::vector<AiAction>& actions = worker.actions[ply];
+    AiPlayer::generateActions(state, actions);
+    if (actions.empty()) return AiPlayer::evaluate(state);
+
+    // The table's best move first, then attacks, then moves
+    std::vector<int>& order = worker.order[ply];
+    order.clear();
+    int actionCount = static_cast<int>(actions.size());
+    if (tableMove >= actionCount) tableMove = -1;  // a colliding key's move
+    if (tableMove != -1) order.push_back(tableMove);
+    for (int i = 0; i < actionCount; i++) {
+        if (i != tableMove && actions[i].type == ATTACK) order.push_back(i);
+    }
+    for (int i = 0; i < actionCount; i++) {
+        if (i != tableMove && actions[i].type != ATTACK) order.push_back(i);
+    }
+
+    int originalAlpha = alpha;
+    int best = -INFINITE_SCORE;
+    int bestMove = -1;
+    for (int index : order) {
+        StepUndo undo;
+        AiPlayer::apply(state, actions[index], undo);
+        int score = -negamax(worker, state, depth - 1, -beta, -alpha, ply + 1);
+        state.undo(undo);
+        if (search.stopped) return 0;
+        if (score > best) {
+            best = score;
+            bestMove = index;
+        }
+        if (score > alpha) alpha = score;
+        if (alpha >= beta) break;
+    }
+
+    TranspositionTable::Bound bound = best <= originalAlpha ? TranspositionTable::UPPER
+                                    : best >= beta          ? TranspositionTable::LOWER
+                                                            : TranspositionTable::EXACT;
+    search.table.store(key, {toTable(best, ply), depth, bound, bestMove});
+    return best;
+}
+}
+
+TranspositionTable::TranspositionTable(int bits)
+    : slots(new Slot[size_t(1) << bits]), mask((uint64_t(1) << bits) - 1) {}
+
+bool TranspositionTable::probe(uint64_t key, Entry& entry) const {
+    const Slot& slot = slots[key & mask];
+    uint64_t data = slot.data.load(std::memory_order_relaxed);
+    uint64_t check = slot.check.load(std::memory_order_relaxed);
+    // Bit 63 marks a used slot
+    if ((data >> 63) == 0 || (check ^ data) != key) return false;
+    entry.score = static_cast<int32_t>(static_cast<uint32_t>(data));
+    entry.depth = static_cast<int>((data >> 32) & 0xff);
+    entry.bound = static_cast<Bound>((data >> 40) & 0x3);
+    entry.move = static_cast<int>((data >> 48) & 0x7fff) - 1;
+    return true;
+}
+
+void TranspositionTable::store(uint64_t key, const Entry& entry) {
+    Slot& slot = slots[key & mask];
+    uint64_t data = static_cast<uint32_t>(entry.score)
+                  | static_cast<uint64_t>(entry.depth & 0xff) << 32
+                  | static_cast<uint64_t>(entry.bound) << 40
+                  | static_cast<uint64_t>((entry.move + 1) & 0x7fff) << 48
+                  | uint64_t(1) << 63;
+    slot.check.store(key ^ data, std::memory_order_relaxed);
+    slot.data.store(data, std::memory_order_relaxed);
+}
+
+void TranspositionTable::clear() {
+    for (uint64_t i = 0; i <= mask; i++) {
+        slots[i].check.store(0, std::memory_order_relaxed);
+        slots[i].data.store(0, std::memory_order_relaxed);
+    }
+}
+
+AiPlayer::AiPlayer(const AiSettings& settings)
+    : settings(settings), table(settings.tableBits) {
+    if (settings.threads != 1) {
+        pool = std::make_unique<ThreadPool>(settings.threads);
+    }
+}
+
+void AiPlayer::generateActions(const GameState& state, std::vector<AiAction>& actions) {
+    actions.clear();
+    const UnitPool& units = state.getUnits();
+    for (int i = 0; i < units.size(); i++) {
+        if (units.getPlayer(i) != state.getCurrentPlayer()) continue;
+
+        Unit unit = units.get(i);
+        for (const Point& point : state.getAttackRangeOf(i)) {
+            int target = state.unitAt(point.x, point.y);
+            if (target != -1 && units.getPlayer(target) != unit.getPlayer() && unit.inAttackRange(point.x, point.y)) {
+                actions.push_back({ATTACK, i, point.x, point.y});
+            }
+        }
+        // Friendly tiles can be walked through but not ended on
+        for (const Point& point : state.getMovementRangeOf(i)) {
+            if (state.unitAt(point.x, point.y) == -1) {
+                actions.push_back({MOVE, i, point.x, point.y});
+            }
+        }
+    }
+}
+
+bool AiPlayer::apply(GameState& state, const AiAction& action, StepResult* result) {
+    const UnitPool& units = state.getUnits();
+    if (state.step({SELECT, units.getX(action.unitIndex), units.getY(action.unitIndex)}).outcome != SELECTED) return false;
+    StepResult outcome = state.step({action.type, action.x, action.y});
+    if (result) *result = outcome;
+    return outcome.outcome != INVALID_COMMAND;
+}
+
+bool AiPlayer::apply(GameState& state, const AiAction& action, StepUndo& undo) {
+    const UnitPool& units = state.getUnits();
+    if (state.step({SELECT, units.getX(action.unitIndex), units.getY(action.unitIndex)}).outcome != SELECTED) {
+        undo = StepUndo();
+        return false;
+    }
+    return state.step({action.type, action.x, action.y}, undo).outcome != INVALID_COMMAND;
+}
+
+int AiPlayer::evaluate(const GameState& state) {
+    // Material (health weighted by how much a unit can hurt and how far it
+    // reaches), plus a small pull of each side towards the other's centre
+    long material[3] = {0, 0, 0};
+    long sumX[3] = {0, 0, 0};
+    long sumY[3] = {0, 0, 0};
+    long count[3] = {0, 0, 0};
+    const UnitPool& units = state.getUnits();
+    for (int i = 0; i < units.size(); i++) {
+        int player = units.getPlayer(i);
+        if (player < 1 || player > 2) continue;
+        material[player] += static_cast<long>(units.getHealth(i)) * unitValue(units.getType(i));
+        sumX[player] += units.getX(i);
+        sumY[player] += units.getY(i);
+        count[player]++;
+    }
+
+    int me = state.getCurrentPlayer();
+    int other = me == 1 ? 2 : 1;
+    long score = (material[me] - material[other]) / 10;
+    if (count[me] > 0 && count[other] > 0) {
+        for (int i = 0; i < units.size(); i++) {
+            int player = units.getPlayer(i);
+            if (player < 1 || player > 2) continue;
+            int enemy = player == 1 ? 2 : 1;
+            long distance = (std::abs(units.getX(i) * count[enemy] - sumX[enemy]) + std::abs(units.getY(i) * count[enemy] - sumY[enemy])) / count[enemy];
+            score += player == me ? -distance : distance;
+        }
+    }
+    return static_cast<int>(score);
+}
+
+bool AiPlayer::chooseAction(const GameState& state, AiAction& action) {
+    BATTLE_PROFILE_SCOPE("ai_search");
+    Clock::time_point start = Clock::now();
+    lastStats = AiStats();
+    if (state.getWinner() != 0) return false;
+
+    std::vector<AiAction> actions;
+    generateActions(state, actions);
+    if (actions.empty()) return false;
+
+    int actionCount = static_cast<int>(actions.size());
+    Search search(state, table, start + std::chrono::milliseconds(settings.timeBudgetMs));
+    // Score of root action `index` within (alpha, beta)
+    auto searchRoot = [&search, &actions](int index, int depth, int alpha, int beta) {
+        Worker worker(search, depth);
+        std::unique_ptr<GameState> child = search.acquireState();
+        StepUndo undo;
+        apply(*child, actions[index], undo);
+        int score = -negamax(worker, *child, depth - 1, -beta, -alpha, 1);
+        child->undo(undo);
+        search.releaseState(std::move(child));
+        return score;
+    };
+
+    // Root actions, best first by the previous iteration's scores
+    std::vector<int> order(actionCount);
+    std::iota(order.begin(), order.end(), 0);
+    std::vector<int> scores(actionCount, 0);
+    action = actions[0];
+
+    for (int depth = 1; depth <= settings.maxDepth; depth++) {
+        search.mayStop = depth > 1;
+
+        // The first action alone sets the bound the parallel ones start from
+        int first = order[0];
+        scores[first] = searchRoot(first, depth, -INFINITE_SCORE, INFINITE_SCORE);
+        if (search.stopped) break;
+
+        // Only a score above the bound an action was searched with is exact;
+        // one that fails low is an upper bound and may tie the best, so the
+        // best action is tracked here rather than read back from the scores
+        int bestIndex = first;
+        int bestScore = scores[first];
+        std::mutex bestMutex;
+        std::atomic<int> alpha(bestScore);
+        auto searchNext = [&](int index) {
+            if (search.mayStop && Clock::now() >= search.deadline) search.stopped = true;
+            int bound = alpha.load();
+            int score = searchRoot(index, depth, bound, INFINITE_SCORE);
+            scores[index] = score;
+            if (score <= bound || search.stopped) return;
+            std::lock_guard<std::mutex> lock(bestMutex);
+            if (score > bestScore) {
+                bestScore = score;
+                bestIndex = index;
+                alpha.store(score);
+            }
+        };
+        if (pool) {
+            std::atomic<int> pending(actionCount - 1);
+            for (int i = 1; i < actionCount; i++) {
+                int index = order[i];
+                pool->submit([&searchNext, &pending, index] {
+                    searchNext(index);
+                    pending--;
+                });
+            }
+            pool->wait(pending);
+        } else {
+            for (int i = 1; i < actionCount; i++) {
+                searchNext(order[i]);
+            }
+        }
+        if (search.stopped) break;
+
+        // The best first, the rest by their (bounded) scores
+        std::stable_sort(order.begin(), order.end(), [&scores, bestIndex](int a, int b) {
+            if (a == bestIndex || b == bestIndex) return a == bestIndex && b != bestIndex;
+            return scores[a] > scores[b];
+        });
+        action = actions[bestIndex];
+        lastStats.depth = depth;
+        lastStats.score = bestScore;
+        // Nothing left to learn: a forced result, or a single choice
+        if (isWin(lastStats.score) || actionCount == 1) break;
+    }
+
+    lastStats.nodes = search.nodes;
+    lastStats.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return true;
+}
@@ -0,0 +1,25 @@
+#include "allocation_counter.hpp"
+
+namespace {
+
+// Trivially initialized, so touching it from operator new never allocates
+thread_local AllocationStats counters;
+bool enabled = false;
+
+}
+
+bool allocationCountingEnabled() {
+    return enabled;
+}
+
+AllocationStats threadAllocationStats() {
+    return counters;
+}
+
+AllocationStats& threadAllocationCounters() {
+    return counters;
+}
+
+void enableAllocationCounting() {
+    enabled = true;
+}
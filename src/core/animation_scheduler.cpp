@@ -0,0 +1,124 @@
+#include "animation_scheduler.hpp"
+#include <algorithm>
+#include <cmath>
+
+template <typename Done>
+void AnimationScheduler::retireMoves(Done done) {
+    // Like remove_if, but swapping, so finished walks keep their path buffers
+    auto kept = moves.begin();
+    for (auto it = moves.begin(); it != moves.end(); ++it) {
+        if (done(*it)) continue;
+        if (kept != it) std::swap(*kept, *it);
+        ++kept;
+    }
+    for (auto it = kept; it != moves.end(); ++it) {
+        sparePaths.push_back(std::move(it->path));
+    }
+    moves.erase(kept, moves.end());
+}
+
+void AnimationScheduler::startMove(UnitHandle unit, const std::vector<Point>& path) {
+    cancelUnit(unit);
+    if (path.size() < 2) return;
+    UnitMoveAnimation move = {unit, {}, 0.0};
+    // A finished walk's buffer, so steady play doesn't allocate per move
+    if (!sparePaths.empty()) {
+        move.path.swap(sparePaths.back());
+        sparePaths.pop_back();
+    }
+    move.path.assign(path.begin(), path.end());
+    moves.push_back(std::move(move));
+}
+
+void AnimationScheduler::startExplosion(Point tile) {
+    explosions.push_back({tile, 0.0});
+}
+
+void AnimationScheduler::cancelUnit(UnitHandle unit) {
+    retireMoves([unit](const UnitMoveAnimation& move) { return move.unit == unit; });
+}
+
+void AnimationScheduler::update(double elapsedMs, GameState& state) {
+    if (isIdle()) {
+        accumulatorMs = 0.0;
+        return;
+    }
+    accumulatorMs += elapsedMs;
+    // Don't try to catch up after a long stall (window drag, breakpoint)
+    accumulatorMs = std::min(accumulatorMs, STEP_MS * 10);
+    while (accumulatorMs >= STEP_MS) {
+        tick(state);
+        accumulatorMs -= STEP_MS;
+    }
+    if (isIdle()) accumulatorMs = 0.0;
+}
+
+void AnimationScheduler::tick(GameState& state) {
+    for (UnitMoveAnimation& move : moves) {
+        move.elapsedMs += STEP_MS;
+        size_t leg = std::min(static_cast<size_t>(move.elapsedMs / MOVE_MS_PER_TILE), move.path.size() - 2);
+        int deltaX = move.path[leg + 1].x - move.path[leg].x;
+        int deltaY = move.path[leg + 1].y - move.path[leg].y;
+
+        // Set orientation based on direction
+        int orientation = -1;
+        if (deltaX > 0) orientation = 0;      // right
+        else if (deltaY > 0) orientation = 1; // down
+        else if (deltaX < 0) orientation = 2; // left
+        else if (deltaY < 0) orientation = 3; // up
+        int index = state.indexOf(move.unit);
+        if (orientation != -1 && index != -1) state.setUnitOrientation(index, orientation);
+    }
+    retireMoves([&state](const UnitMoveAnimation& move) {
+        return move.elapsedMs >= MOVE_MS_PER_TILE * (move.path.size() - 1) || state.indexOf(move.unit) == -1;
+    });
+
+    for (ExplosionAnimation& explosion : explosions) {
+        explosion.elapsedMs += STEP_MS;
+    }
+    explosions.erase(std::remove_if(explosions.begin(), explosions.end(),
+                                    [](const ExplosionAnimation& explosion) { return explosion.elapsedMs >= EXPLOSION_FRAME_MS * EXPLOSION_TOTAL_FRAMES; }),
+                     explosions.end());
+}
+
+bool AnimationScheduler::unitPosition(UnitHandle unit, int tileSize, int& pixelX, int& pixelY) const {
+    for (const UnitMoveAnimation& move : moves) {
+        if (move.unit != unit) continue;
+        double progress = interpolatedElapsed(move.elapsedMs) / MOVE_MS_PER_TILE;
+        size_t leg = static_cast<size_t>(progress);
+        if (leg >= move.path.size() - 1) {
+            pixelX = move.path.back().x * tileSize;
+            pixelY = move.path.back().y * tileSize;
+            return true;
+        }
+        double fraction = progress - leg;
+        const Point& from = move.path[leg];
+        const Point& to = move.path[leg + 1];
+        pixelX = static_cast<int>(std::lround((from.x + (to.x - from.x) * fraction) * tileSize));
+        pixelY = static_cast<int>(std::lround((from.y + (to.y - from.y) * fraction) * tileSize));
+        return true;
+    }
+    return false;
+}
+
+int AnimationScheduler::explosionFrame(const ExplosionAnimation& explosion) const {
+    int frame = static_cast<int>(explosion.elapsedMs / EXPLOSION_FRAME_MS);
+    return std::min(frame, EXPLOSION_TOTAL_FRAMES - 1);
+}
+
+void AnimationScheduler::coveredTiles(int tileSize, std::vector<Point>& tiles) const {
+    for (const UnitMoveAnimation& move : moves) {
+        int pixelX = 0, pixelY = 0;
+        unitPosition(move.unit, tileSize, pixelX, pixelY);
+        int left = pixelX / tileSize, top = pixelY / tileSize;
+        int right = (pixelX + tileSize - 1) / tileSize, bottom = (pixelY + tileSize - 1) / tileSize;
+        for (int y = top; y <= bottom; y++) {
+            for (int x = left; x <= right; x++) {
+                tiles.push_back({x, y});
+            }
+        }
+    }
+    for (const ExplosionAnimation& explosion : explosions) {
+        tiles.push_back(explosion.tile);
+    }
+}
@@ -0,0 +1,78 @@
+#include "arena.hpp"
+#include <algorithm>
+#include <cstdint>
+
+namespace {
+
+size_t alignUp(const unsigned char* base, size_t offset, size_t alignment) {
+    uintptr_t address = reinterpret_cast<uintptr_t>(base) + offset;
+    uintptr_t aligned = (address + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+    return offset + (aligned - address);
+}
+
+}
+
+Arena::Arena(size_t blockBytes)
+    : blockBytes(blockBytes) {}
+
+void* Arena::allocate(size_t bytes, size_t alignment) {
+    while (true) {
+        if (current < blocks.size()) {
+            Block& block = blocks[current];
+            size_t start = alignUp(block.data.get(), offset, alignment);
+            if (start + bytes <= block.size) {
+                offset = start + bytes;
+                highWater = std::max(highWater, bytesUsed());
+                return block.data.get() + start;
+            }
+            if (current + 1 < blocks.size() && blocks[current + 1].size >= bytes + alignment) {
+                current++;
+                offset = 0;
+                continue;
+            }
+        }
+        // Later blocks stay for the next overflow; this one goes right after the current
+        size_t size = std::max(blockBytes, bytes + alignment);
+        size_t position = blocks.empty() ? 0 : current + 1;
+        blocks.insert(blocks.begin() + position, Block{std::unique_ptr<unsigned char[]>(new unsigned char[size]), size});
+        current = position;
+        offset = 0;
+    }
+}
+
+void Arena::rewind(Mark mark) {
+    current = mark.block;
+    offset = mark.offset;
+}
+
+void Arena::reset() {
+    if (blocks.size() > 1) {
+        // One block big enough for the whole of the last use
+        size_t size = capacityBytes();
+        blocks.clear();
+        blocks.push_back({std::unique_ptr<unsigned char[]>(new unsigned char[size]), size});
+    }
+    current = 0;
+    offset = 0;
+}
+
+size_t Arena::bytesUsed() const {
+    size_t used = offset;
+    for (size_t i = 0; i < current && i < blocks.size(); i++) {
+        used += blocks[i].size;
+    }
+    return used;
+}
+
+size_t Arena::capacityBytes() const {
+    size_t capacity = 0;
+    for (const Block& block : blocks) {
+        capacity += block.size;
+    }
+    return capacity;
+}
+
+Arena& scratchArena() {
+    thread_local Arena arena;
+    return arena;
+}
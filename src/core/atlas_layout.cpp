@@ -0,0 +1,106 @@
+#include "atlas_layout.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+
+bool loadAtlasLayout(const std::string& filename, AtlasLayout& layout) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    std::string keyword;
+    int version = 0, pageCount = 0, spriteCount = 0;
+    if (!(file >> keyword >> version >> layout.tileSize >> pageCount >> spriteCount) || keyword != "atlas" ||
+        version != ATLAS_LAYOUT_VERSION || spriteCount != SPRITE_COUNT || pageCount < 0) {
+        std::cerr << "Unsupported atlas layout: " << filename << std::endl;
+        return false;
+    }
+
+    std::filesystem::path directory = std::filesystem::path(filename).parent_path();
+    layout.pages.assign(pageCount, AtlasPage());
+    layout.sprites.assign(spriteCount, AtlasSprite());
+    for (AtlasPage& page : layout.pages) {
+        if (!(file >> keyword >> page.file >> page.width >> page.height) || keyword != "page") {
+            std::cerr << "Truncated atlas layout: " << filename << std::endl;
+            return false;
+        }
+        page.file = (directory / page.file).string();
+    }
+    for (int i = 0; i < spriteCount; i++) {
+        int id;
+        std::string name;
+        AtlasSprite sprite;
+        if (!(file >> keyword >> id >> name >> sprite.page >> sprite.x >> sprite.y >> sprite.w >> sprite.h >> sprite.offsetX >> sprite.offsetY) ||
+            keyword != "sprite") {
+            std::cerr << "Truncated atlas layout: " << filename << std::endl;
+            return false;
+        }
+        if (id < 0 || id >= spriteCount || sprite.page < -1 || sprite.page >= pageCount) {
+            std::cerr << "Invalid sprite in atlas layout: " << filename << std::endl;
+            return false;
+        }
+        layout.sprites[id] = sprite;
+    }
+    return true;
+}
+
+bool saveAtlasLayout(const AtlasLayout& layout, const std::string& filename) {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Unable to write atlas layout: " << filename << std::endl;
+        return false;
+    }
+
+    file << "atlas " << ATLAS_LAYOUT_VERSION << " " << layout.tileSize << " " << layout.pages.size() << " " << layout.sprites.size() << "\n";
+    for (const AtlasPage& page : layout.pages) {
+        file << "page " << page.file << " " << page.width << " " << page.height << "\n";
+    }
+    for (size_t i = 0; i < layout.sprites.size(); i++) {
+        const AtlasSprite& sprite = layout.sprites[i];
+        file << "sprite " << i << " " << spriteName(static_cast<int>(i)) << " " << sprite.page << " " << sprite.x << " " << sprite.y
+             << " " << sprite.w << " " << sprite.h << " " << sprite.offsetX << " " << sprite.offsetY << "\n";
+    }
+    return static_cast<bool>(file);
+}
+
+bool packAtlas(std::vector<AtlasSprite>& sprites, int pageSize, int padding, std::vector<AtlasPage>& pages) {
+    std::vector<int> order(sprites.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&sprites](int a, int b) {
+        return sprites[a].h != sprites[b].h ? sprites[a].h > sprites[b].h : sprites[a].w > sprites[b].w;
+    });
+
+    pages.clear();
+    int shelfY = padding, shelfHeight = 0, cursorX = padding;
+    for (int index : order) {
+        AtlasSprite& sprite = sprites[index];
+        if (sprite.page == -1) continue;
+        if (sprite.w + 2 * padding > pageSize || sprite.h + 2 * padding > pageSize) {
+            std::cerr << "Sprite " << spriteName(index) << " does not fit a " << pageSize << " px atlas page" << std::endl;
+            return false;
+        }
+        if (cursorX + sprite.w + padding > pageSize) {
+            shelfY += shelfHeight;
+            cursorX = padding;
+            shelfHeight = 0;
+        }
+        if (pages.empty() || shelfY + sprite.h + padding > pageSize) {
+            pages.push_back(AtlasPage());
+            shelfY = cursorX = padding;
+            shelfHeight = 0;
+        }
+
+        AtlasPage& page = pages.back();
+        sprite.page = static_cast<int>(pages.size()) - 1;
+        sprite.x = cursorX;
+        sprite.y = shelfY;
+        cursorX += sprite.w + padding;
+        shelfHeight = std::max(shelfHeight, sprite.h + padding);
+        page.width = std::max(page.width, cursorX);
+        page.height = std::max(page.height, shelfY + shelfHeight);
+    }
+    return true;
+}
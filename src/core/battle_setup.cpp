@@ -0,0 +1,30 @@
+#include "battle_setup.hpp"
+#include <iostream>
+#include "map_generator.hpp"
+
+bool loadBattle(const BattleSetup& setup, GameState& state) {
+    int width = setup.randomWidth, height = setup.randomHeight;
+    if (!setup.randomMap() && !Map::measureMapFile(setup.mapFile, width, height)) {
+        std::cerr << "Failed to measure map: " << setup.mapFile << std::endl;
+        return false;
+    }
+    if (setup.maxMapSize > 0 && (width > setup.maxMapSize || height > setup.maxMapSize)) {
+        std::cerr << "Map larger than " << setup.maxMapSize << "x" << setup.maxMapSize << " is not supported." << std::endl;
+        return false;
+    }
+
+    state = GameState(width, height);
+    if (setup.randomMap()) {
+        generateTerrain(state.getMutableMap(), setup.terrainSeed);
+    } else if (!state.loadMap(setup.mapFile)) {
+        std::cerr << "Failed to load map: " << setup.mapFile << std::endl;
+        return false;
+    }
+    for (int player = 1; player <= 2; player++) {
+        if (!state.loadUnits(setup.layouts[player], player)) {
+            std::cerr << "Failed to load units for player " << player << ": " << setup.layouts[player] << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,29 @@
+#include "bit_grid.hpp"
+#include <algorithm>
+
+BitGrid::BitGrid(int width, int height)
+    : width(width), height(height), wordsPerRow((width + 63) / 64),
+      words(static_cast<size_t>(wordsPerRow) * height, 0) {}
+
+void BitGrid::clear() {
+    std::fill(words.begin(), words.end(), 0);
+}
+
+void BitGrid::fill() {
+    uint64_t lastWordMask = (width % 64) ? (uint64_t(1) << (width % 64)) - 1 : ~uint64_t(0);
+    for (int y = 0; y < height; y++) {
+        uint64_t* words = row(y);
+        for (int word = 0; word < wordsPerRow; word++) {
+            words[word] = ~uint64_t(0);
+        }
+        if (wordsPerRow > 0) words[wordsPerRow - 1] = lastWordMask;
+    }
+}
+
+size_t BitGrid::count() const {
+    size_t total = 0;
+    for (uint64_t word : words) {
+        total += __builtin_popcountll(word);
+    }
+    return total;
+}
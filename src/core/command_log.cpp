@@ -0,0 +1,208 @@
+#include "command_log.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include "allocation_counter.hpp"
+#include "binary_layout.hpp"
+#include "mapped_file.hpp"
+
+namespace {
+
+const size_t COMMAND_BYTES = 5;
+const size_t HASH_BYTES = 8;
+
+template <typename T>
+void append(std::vector<uint8_t>& bytes, T value) {
+    uint8_t raw[sizeof(T)];
+    std::memcpy(raw, &value, sizeof(T));
+    bytes.insert(bytes.end(), raw, raw + sizeof(T));
+}
+
+template <typename T>
+T read(const uint8_t* data) {
+    T value;
+    std::memcpy(&value, data, sizeof(T));
+    return value;
+}
+
+uint64_t hashTerrain(const Map& map) {
+    uint64_t hash = 14695981039346656037ULL;
+    const uint8_t* terrain = map.getTerrainData();
+    for (size_t i = 0, count = static_cast<size_t>(map.getWidth()) * map.getHeight(); i < count; i++) {
+        hash ^= terrain[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+}
+
+void CommandLog::begin(const GameState& state) {
+    mapWidth = state.getMap().getWidth();
+    mapHeight = state.getMap().getHeight();
+    unitCount = state.getUnits().size();
+    terrainHash = hashTerrain(state.getMap());
+    initialHash = state.stateHash();
+    turns = 0;
+    bytes.clear();
+}
+
+void CommandLog::record(const Command& command, const StepResult& result, const GameState& state) {
+    if (result.outcome == INVALID_COMMAND) return;
+    append<uint8_t>(bytes, static_cast<uint8_t>(command.type));
+    append<uint16_t>(bytes, static_cast<uint16_t>(command.x));
+    append<uint16_t>(bytes, static_cast<uint16_t>(command.y));
+    if (command.type != SELECT) {
+        append<uint64_t>(bytes, state.stateHash());
+        turns++;
+    }
+}
+
+bool CommandLog::next(size_t& offset, LoggedCommand& entry) const {
+    if (offset + COMMAND_BYTES > bytes.size()) return false;
+    const uint8_t* data = bytes.data() + offset;
+    if (data[0] > ATTACK) return false;
+    entry.command = {static_cast<CommandType>(data[0]), read<uint16_t>(data + 1), read<uint16_t>(data + 3)};
+    entry.endsTurn = entry.command.type != SELECT;
+    entry.stateHash = 0;
+    if (entry.endsTurn) {
+        if (offset + COMMAND_BYTES + HASH_BYTES > bytes.size()) return false;
+        entry.stateHash = read<uint64_t>(data + COMMAND_BYTES);
+        offset += HASH_BYTES;
+    }
+    offset += COMMAND_BYTES;
+    return true;
+}
+
+bool CommandLog::save(const std::string& filename) const {
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Unable to write command log: " << filename << std::endl;
+        return false;
+    }
+
+    CommandLogHeader header = {};
+    std::memcpy(header.magic, "BNCL", 4);
+    header.version = COMMAND_LOG_VERSION;
+    header.mapWidth = static_cast<uint32_t>(mapWidth);
+    header.mapHeight = static_cast<uint32_t>(mapHeight);
+    header.unitCount = static_cast<uint32_t>(unitCount);
+    header.terrainHash = terrainHash;
+    header.initialHash = initialHash;
+    header.byteCount = bytes.size();
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    return static_cast<bool>(file);
+}
+
+bool CommandLog::load(const std::string& filename) {
+    MappedFile file;
+    if (!file.open(filename)) {
+        std::cerr << "Unable to open command log: " << filename << std::endl;
+        return false;
+    }
+
+    CommandLogHeader header;
+    if (file.size() < sizeof(header)) {
+        std::cerr << "Truncated command log: " << filename << std::endl;
+        return false;
+    }
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, "BNCL", 4) != 0 || header.version != COMMAND_LOG_VERSION) {
+        std::cerr << "Unsupported command log: " << filename << std::endl;
+        return false;
+    }
+    if (!fitsInFile(sizeof(header), header.byteCount, file.size())) {
+        std::cerr << "Truncated command log: " << filename << std::endl;
+        return false;
+    }
+
+    mapWidth = static_cast<int>(header.mapWidth);
+    mapHeight = static_cast<int>(header.mapHeight);
+    unitCount = static_cast<int>(header.unitCount);
+    terrainHash = header.terrainHash;
+    initialHash = header.initialHash;
+    bytes.assign(file.data() + sizeof(header), file.data() + sizeof(header) + header.byteCount);
+
+    turns = 0;
+    size_t offset = 0;
+    LoggedCommand entry;
+    while (next(offset, entry)) {
+        if (entry.endsTurn) turns++;
+    }
+    if (offset != bytes.size()) {
+        std::cerr << "Corrupt command log: " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+ReplayResult CommandLog::replay(GameState& state) const {
+    ReplayResult result;
+    if (state.getMap().getWidth() != mapWidth || state.getMap().getHeight() != mapHeight ||
+        state.getUnits().size() != unitCount || hashTerrain(state.getMap()) != terrainHash ||
+        state.stateHash() != initialHash) {
+        std::cerr << "Replay start state does not match the recorded layout" << std::endl;
+        return result;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    AllocationScope allocations;
+    size_t offset = 0;
+    LoggedCommand entry;
+    while (next(offset, entry)) {
+        StepResult step = state.step(entry.command);
+        result.commands++;
+        if (step.outcome == INVALID_COMMAND) {
+            result.mismatchTurn = result.turns;
+            break;
+        }
+        if (entry.endsTurn) {
+            if (state.stateHash() != entry.stateHash) {
+                result.mismatchTurn = result.turns;
+                break;
+            }
+            result.turns++;
+        }
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.allocations = allocations.allocations();
+    result.ok = result.mismatchTurn == -1;
+    return result;
+}
+
+CommandLog recordRandomGame(GameState& state, long turns, unsigned seed) {
+    CommandLog log;
+    log.begin(state);
+    std::mt19937 random(seed);
+    std::uniform_int_distribution<int> column(0, std::max(state.getMap().getWidth() - 1, 0));
+    std::uniform_int_distribution<int> row(0, std::max(state.getMap().getHeight() - 1, 0));
+    std::vector<int> own;
+    long attempts = 0;
+    while (log.getTurnCount() < turns && !state.getWinner() && attempts++ < turns * 1000) {
+        const UnitPool& units = state.getUnits();
+        own.clear();
+        for (int i = 0; i < units.size(); i++) {
+            if (units.getPlayer(i) == state.getCurrentPlayer()) own.push_back(i);
+        }
+        if (own.empty()) break;
+        int picked = own[random() % own.size()];
+        Command select = state.commandForClick(units.getX(picked), units.getY(picked));
+        log.record(select, state.step(select), state);
+
+        const std::vector<Point>& moves = state.getMovementRange();
+        const std::vector<Point>& attacks = state.getAttackRange();
+        size_t options = moves.size() + attacks.size();
+        Point target = options == 0 ? Point{column(random), row(random)} : Point{0, 0};
+        if (options > 0) {
+            size_t pick = random() % options;
+            target = pick < moves.size() ? moves[pick] : attacks[pick - moves.size()];
+        }
+        Command command = state.commandForClick(target.x, target.y);
+        log.record(command, state.step(command), state);
+    }
+    return log;
+}
@@ -0,0 +1,263 @@
+#include "flood_fill.hpp"
+#include <algorithm>
+#include "arena.hpp"
+
+namespace {
+
+// `count` (<= 64) bits of row y starting at column x0; columns outside the
+// grid read as zero, so the window can hang over the map edge
+uint64_t extractBits(const BitGrid& grid, int x0, int y, int count) {
+    if (y < 0 || y >= grid.getHeight() || count <= 0) return 0;
+    int skip = 0;
+    if (x0 < 0) {
+        skip = -x0;
+        x0 = 0;
+    }
+    if (skip >= count || x0 >= grid.getWidth()) return 0;
+
+    const uint64_t* row = grid.row(y);
+    int word = x0 >> 6, bit = x0 & 63;
+    uint64_t bits = row[word] >> bit;
+    if (bit != 0 && word + 1 < grid.getWordsPerRow()) {
+        bits |= row[word + 1] << (64 - bit);
+    }
+    bits <<= skip;
+    return count == 64 ? bits : bits & ((uint64_t(1) << count) - 1);
+}
+
+struct Window {
+    int originX, originY;
+    int size;          // tiles per side, 2 * range + 1
+    int wordsPerRow;
+    // wordsPerRow * size words each, from the scratch arena
+    uint64_t* allowed;
+    uint64_t* reached;
+    uint64_t* next;
+};
+
+void loadWindow(Window& window, const BitGrid& passable, const BitGrid& occupied, const BitGrid& friendly,
+                int x, int y, int range) {
+    window.size = 2 * range + 1;
+    window.originX = x - range;
+    window.originY = y - range;
+    window.wordsPerRow = (window.size + 63) / 64;
+    size_t words = static_cast<size_t>(window.wordsPerRow) * window.size;
+    Arena& arena = scratchArena();
+    window.allowed = arena.allocateArray<uint64_t>(words);
+    window.reached = arena.allocateArray<uint64_t>(words);
+    window.next = arena.allocateArray<uint64_t>(words);
+    std::fill(window.reached, window.reached + words, 0);
+    std::fill(window.next, window.next + words, 0);
+
+    for (int row = 0; row < window.size; row++) {
+        for (int word = 0; word < window.wordsPerRow; word++) {
+            int column = window.originX + word * 64;
+            int count = std::min(64, window.size - word * 64);
+            int mapY = window.originY + row;
+            uint64_t enemies = extractBits(occupied, column, mapY, count) & ~extractBits(friendly, column, mapY, count);
+            window.allowed[row * window.wordsPerRow + word] = extractBits(passable, column, mapY, count) & ~enemies;
+        }
+    }
+}
+
+void growWindow(Window& window, int range) {
+    int wordsPerRow = window.wordsPerRow;
+    int center = range;
+    window.reached[center * wordsPerRow + (center >> 6)] = uint64_t(1) << (center & 63);
+
+    for (int step = 0; step < range; step++) {
+        bool changed = false;
+        for (int row = 0; row < window.size; row++) {
+            const uint64_t* current = &window.reached[row * wordsPerRow];
+            const uint64_t* above = row > 0 ? current - wordsPerRow : nullptr;
+            const uint64_t* below = row + 1 < window.size ? current + wordsPerRow : nullptr;
+            for (int word = 0; word < wordsPerRow; word++) {
+                uint64_t bits = current[word];
+                uint64_t grown = bits | (bits << 1) | (bits >> 1);
+                if (word > 0) grown |= current[word - 1] >> 63;
+                if (word + 1 < wordsPerRow) grown |= current[word + 1] << 63;
+                if (above) grown |= above[word];
+                if (below) grown |= below[word];
+                uint64_t result = bits | (grown & window.allowed[row * wordsPerRow + word]);
+                changed |= result != bits;
+                window.next[row * wordsPerRow + word] = result;
+            }
+        }
+        std::swap(window.reached, window.next);
+        if (!changed) break;
+    }
+    // Bits shifted past the window's right edge must not count
+    if (window.size % 64 != 0) {
+        uint64_t lastMask = (uint64_t(1) << (window.size % 64)) - 1;
+        for (int row = 0; row < window.size; row++) {
+            window.reached[row * wordsPerRow + wordsPerRow - 1] &= lastMask;
+        }
+    }
+}
+
+void collectWindow(const Window& window, int x, int y, std::vector<Point>& out) {
+    for (int row = 0; row < window.size; row++) {
+        for (int word = 0; word < window.wordsPerRow; word++) {
+            for (uint64_t bits = window.reached[row * window.wordsPerRow + word]; bits; bits &= bits - 1) {
+                int tileX = window.originX + word * 64 + __builtin_ctzll(bits);
+                int tileY = window.originY + row;
+                if (tileX != x || tileY != y) out.push_back({tileX, tileY});
+            }
+        }
+    }
+}
+
+// growWindow() for one unit type: everything sized by the move range is a
+// constant, so the loops unroll and the scratch lives on the stack
+template <UnitType type>
+void growUnitWindow(const BitGrid& passable, const BitGrid& occupied, const BitGrid& friendly,
+                    int x, int y, uint64_t* reached) {
+    constexpr int range = UNIT_TRAITS[type].moveRange;
+    constexpr int size = 2 * range + 1;
+    static_assert(size < 64, "a movement window row must fit in one word");
+    int originX = x - range, originY = y - range;
+
+    // Without terrain limits only the map edges are in the way
+    uint64_t onMap = 0;
+    if constexpr (UNIT_TRAITS[type].terrain == ALL_TERRAIN) {
+        int lo = std::max(0, -originX), hi = std::min(size - 1, occupied.getWidth() - 1 - originX);
+        if (lo <= hi) onMap = ((uint64_t(1) << (hi + 1)) - 1) & ~((uint64_t(1) << lo) - 1);
+    }
+    uint64_t allowed[size];
+    for (int row = 0; row < size; row++) {
+        int mapY = originY + row;
+        uint64_t enemies = extractBits(occupied, originX, mapY, size) & ~extractBits(friendly, originX, mapY, size);
+        uint64_t open;
+        if constexpr (UNIT_TRAITS[type].terrain == ALL_TERRAIN) {
+            open = mapY >= 0 && mapY < occupied.getHeight() ? onMap : 0;
+        } else {
+            open = extractBits(passable, originX, mapY, size);
+        }
+        allowed[row] = open & ~enemies;
+        reached[row] = 0;
+    }
+    reached[range] = uint64_t(1) << range;
+
+    uint64_t next[size];
+    for (int step = 0; step < range; step++) {
+        for (int row = 0; row < size; row++) {
+            uint64_t bits = reached[row];
+            uint64_t grown = bits | (bits << 1) | (bits >> 1);
+            if (row > 0) grown |= reached[row - 1];
+            if (row + 1 < size) grown |= reached[row + 1];
+            next[row] = bits | (grown & allowed[row]);
+        }
+        std::copy(next, next + size, reached);
+    }
+}
+
+void floodFill(const BitGrid& passable, const BitGrid& occupied, const BitGrid& friendly,
+               int x, int y, int range, std::vector<Point>& out) {
+    if (range <= 0) return;
+    ArenaScope scope(scratchArena());
+    Window window;
+    loadWindow(window, passable, occupied, friendly, x, y, range);
+    growWindow(window, range);
+    collectWindow(window, x, y, out);
+}
+
+}
+
+void floodFillRange(const BitGrid& passable, const BitGrid& occupied, const BitGrid& friendly,
+                    int x, int y, int range, std::vector<Point>& out) {
+    floodFill(passable, occupied, friendly, x, y, range, out);
+}
+
+template <UnitType type>
+void floodFillRangeOf(const BitGrid& passable, const BitGrid& occupied, const BitGrid& friendly,
+                      int x, int y, std::vector<Point>& out) {
+    constexpr int range = UNIT_TRAITS[type].moveRange;
+    uint64_t reached[2 * range + 1];
+    growUnitWindow<type>(passable, occupied, friendly, x, y, reached);
+    reached[range] &= ~(uint64_t(1) << range);
+    for (int row = 0; row < 2 * range + 1; row++) {
+        for (uint64_t bits = reached[row]; bits; bits &= bits - 1) {
+            out.push_back({x - range + __builtin_ctzll(bits), y - range + row});
+        }
+    }
+}
+
+template <UnitType type>
+void floodFillWindowOf(const BitGrid& passable, const BitGrid& occupied, const BitGrid& friendly,
+                       int x, int y, uint64_t* rows) {
+    growUnitWindow<type>(passable, occupied, friendly, x, y, rows);
+}
+
+template void floodFillRangeOf<INFANTRY>(const BitGrid&, const BitGrid&, const BitGrid&, int, int, std::vector<Point>&);
+template void floodFillRangeOf<TANK>(const BitGrid&, const BitGrid&, const BitGrid&, int, int, std::vector<Point>&);
+template void floodFillRangeOf<BOAT>(const BitGrid&, const BitGrid&, const BitGrid&, int, int, std::vector<Point>&);
+template void floodFillRangeOf<HELICOPTER>(const BitGrid&, const BitGrid&, const BitGrid&, int, int, std::vector<Point>&);
+template void floodFillWindowOf<INFANTRY>(const BitGrid&, const BitGrid&, const BitGrid&, int, int, uint64_t*);
+template void floodFillWindowOf<TANK>(const BitGrid&, const BitGrid&, const BitGrid&, int, int, uint64_t*);
+template void floodFillWindowOf<BOAT>(const BitGrid&, const BitGrid&, const BitGrid&, int, int, uint64_t*);
+template void floodFillWindowOf<HELICOPTER>(const BitGrid&, const BitGrid&, const BitGrid&, int, int, uint64_t*);
+
+void floodFillRangeScalar(const BitGrid& passable, const BitGrid& occupied, const BitGrid& friendly,
+                          int x, int y, int range, std::vector<Point>& out) {
+    if (range <= 0) return;
+    int size = 2 * range + 1;
+    int originX = x - range, originY = y - range;
+    ArenaScope scope(scratchArena());
+    int* distance = scratchArena().allocateArray<int>(static_cast<size_t>(size) * size);
+    std::fill(distance, distance + size * size, -1);
+    Point* toVisit = scratchArena().allocateArray<Point>(static_cast<size_t>(size) * size);
+    int head = 0, tail = 0;
+    toVisit[tail++] = {x, y};
+    distance[range * size + range] = 0;
+
+    const int directions[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+    while (head < tail) {
+        Point current = toVisit[head++];
+        int steps = distance[(current.y - originY) * size + (current.x - originX)];
+        if (steps >= range) continue;
+
+        for (const auto& direction : directions) {
+            int nx = current.x + direction[0];
+            int ny = current.y + direction[1];
+            if (nx < 0 || ny < 0 || nx >= passable.getWidth() || ny >= passable.getHeight()) continue;
+            int& seen = distance[(ny - originY) * size + (nx - originX)];
+            if (seen != -1) continue;
+            bool enemy = occupied.test(nx, ny) && !friendly.test(nx, ny);
+            if (passable.test(nx, ny) && !enemy) {
+                seen = steps + 1;
+                toVisit[tail++] = {nx, ny};
+            }
+        }
+    }
+
+    for (int row = 0; row < size; row++) {
+        for (int column = 0; column < size; column++) {
+            if (distance[row * size + column] > 0) out.push_back({originX + column, originY + row});
+        }
+    }
+}
+
+void floodFillRanges(const UnitPool& units, const std::vector<int>& indices, const Map& map,
+                     const OccupancyGrid& occupancy, std::vector<std::vector<Point>>& ranges) {
+    ranges.resize(indices.size());
+    for (std::vector<Point>& range : ranges) range.clear();
+    for (int typeIndex = 0; typeIndex < UNIT_TYPE_COUNT; typeIndex++) {
+        UnitType unitType = static_cast<UnitType>(typeIndex);
+        const BitGrid& passable = map.getPassability(unitType);
+        forUnitType(unitType, [&](auto type) {
+            for (size_t i = 0; i < indices.size(); i++) {
+                int unit = indices[i];
+                if (units.getType(unit) != unitType || units.getHealth(unit) <= 0) continue;
+                const BitGrid& friendly = occupancy.getPlayerTiles(units.getPlayer(unit));
+#ifdef BATTLE_SCALAR_FLOODFILL
+                (void)type;
+                floodFillRangeScalar(passable, occupancy.getOccupied(), friendly, units.getX(unit), units.getY(unit),
+                                     units.getMoveRange(unit), ranges[i]);
+#else
+                floodFillRangeOf<decltype(type)::value>(passable, occupancy.getOccupied(), friendly,
+                                                        units.getX(unit), units.getY(unit), ranges[i]);
+#endif
+            }
+        });
+    }
+}
@@ -0,0 +1,233 @@
+#include "fog_of_war.hpp"
+#include <algorithm>
+#include "flood_fill.hpp"
+
+namespace {
+
+// A field of view fits in this many rows of one word each, the unit in the middle
+const int SIGHT_WINDOW = 2 * MAX_SIGHT_RANGE + 1;
+static_assert(SIGHT_WINDOW <= 64, "a field of view row must fit in one word");
+
+// Octant coordinates (dx along a row, dy away from the unit) to map offsets
+const int OCTANTS[8][4] = {
+    {1, 0, 0, 1}, {0, 1, 1, 0}, {0, -1, 1, 0}, {-1, 0, 0, 1},
+    {-1, 0, 0, -1}, {0, -1, -1, 0}, {0, 1, -1, 0}, {1, 0, 0, -1},
+};
+
+// Recursive shadowcasting over one octant at a time: rows are scanned
+// outwards and every mountain narrows the slopes still lit behind it.
+struct SightCaster {
+    const Map& map;
+    int originX, originY, radius;
+    uint64_t* rows;  // bit MAX_SIGHT_RANGE + dx of row MAX_SIGHT_RANGE + dy
+
+    bool inside(int x, int y) const { return x >= 0 && y >= 0 && x < map.getWidth() && y < map.getHeight(); }
+
+    void cast(int distance, double start, double end, const int* octant) {
+        if (start < end) return;
+        double nextStart = start;
+        for (; distance <= radius; distance++) {
+            bool blocked = false;
+            int dy = -distance;
+            for (int dx = -distance; dx <= 0; dx++) {
+                double leftSlope = (dx - 0.5) / (dy + 0.5), rightSlope = (dx + 0.5) / (dy - 0.5);
+                if (start < rightSlope) continue;
+                if (end > leftSlope) break;
+
+                int offsetX = dx * octant[0] + dy * octant[1], offsetY = dx * octant[2] + dy * octant[3];
+                int x = originX + offsetX, y = originY + offsetY;
+                bool onMap = inside(x, y);
+                if (onMap && dx * dx + dy * dy <= radius * (radius + 1)) {
+                    rows[MAX_SIGHT_RANGE + offsetY] |= uint64_t(1) << (MAX_SIGHT_RANGE + offsetX);
+                }
+                // Off the map counts as a wall so the scan stops there too
+                bool opaque = !onMap || TERRAIN_TRAITS[map.getTerrain(x, y)].blocksSight;
+                if (blocked) {
+                    if (opaque) {
+                        nextStart = rightSlope;
+                        continue;
+                    }
+                    blocked = false;
+                    start = nextStart;
+                } else if (opaque && distance < radius) {
+                    blocked = true;
+                    cast(distance + 1, start, leftSlope, octant);
+                    nextStart = rightSlope;
+                }
+            }
+            if (blocked) break;
+        }
+    }
+};
+
+// Bits lo..hi of a word, both included
+uint64_t bitRange(int lo, int hi) {
+    uint64_t upTo = hi >= 63 ? ~uint64_t(0) : (uint64_t(1) << (hi + 1)) - 1;
+    return upTo & ~((uint64_t(1) << lo) - 1);
+}
+
+void clearBits(uint64_t* row, int left, int right) {
+    for (int word = left >> 6; word <= right >> 6; word++) {
+        int lo = std::max(left - word * 64, 0), hi = std::min(right - word * 64, 63);
+        row[word] &= ~bitRange(lo, hi);
+    }
+}
+
+TileRect around(Point tile, int range) {
+    return {tile.x - range, tile.y - range, tile.x + range, tile.y + range};
+}
+
+TileRect clipped(TileRect rect, const Map& map) {
+    rect.left = std::max(rect.left, 0);
+    rect.top = std::max(rect.top, 0);
+    rect.right = std::min(rect.right, map.getWidth() - 1);
+    rect.bottom = std::min(rect.bottom, map.getHeight() - 1);
+    return rect;
+}
+
+}
+
+void FogOfWar::rebuild(const GameState& state) {
+    const Map& map = state.getMap();
+    const UnitPool& units = state.getUnits();
+    visible.clear();
+    noTiles = BitGrid(map.getWidth(), map.getHeight());
+    TileRect all = {0, 0, map.getWidth() - 1, map.getHeight() - 1};
+    for (int i = 0; i < units.size(); i++) {
+        light(state, i, grid(units.getPlayer(i)), all);
+    }
+    stats.rebuilds++;
+}
+
+TileRect FogOfWar::unitMoved(const GameState& state, int index, Point from, Point to) {
+    const UnitPool& units = state.getUnits();
+    int range = units.getSightRange(index);
+    TileRect rect = {std::min(from.x, to.x) - range, std::min(from.y, to.y) - range,
+                     std::max(from.x, to.x) + range, std::max(from.y, to.y) + range};
+    rect = clipped(rect, state.getMap());
+    refresh(state, units.getPlayer(index), rect);
+    return rect;
+}
+
+TileRect FogOfWar::unitRemoved(const GameState& state, int player, Point tile) {
+    // Its type is gone with it, so assume the longest sight
+    TileRect rect = clipped(around(tile, MAX_SIGHT_RANGE), state.getMap());
+    refresh(state, player, rect);
+    return rect;
+}
+
+TileRect FogOfWar::unitAdded(const GameState& state, int index) {
+    const UnitPool& units = state.getUnits();
+    TileRect rect = clipped(around({units.getX(index), units.getY(index)}, units.getSightRange(index)), state.getMap());
+    // Sight only adds up, nothing to clear
+    light(state, index, grid(units.getPlayer(index)), rect);
+    stats.updates++;
+    return rect;
+}
+
+bool FogOfWar::isVisible(int player, int x, int y) const {
+    return player >= 0 && player < static_cast<int>(visible.size()) && visible[player].test(x, y);
+}
+
+const BitGrid& FogOfWar::getVisible(int player) const {
+    if (player < 0 || player >= static_cast<int>(visible.size())) return noTiles;
+    return visible[player];
+}
+
+void FogOfWar::knownMovementRange(const GameState& state, int viewer, int index, BitGrid& knownOccupied,
+                                  std::vector<Point>& out) const {
+    // Tiles of hidden enemies count as free, as would any empty tile the
+    // viewer can't see into
+    const OccupancyGrid& occupancy = state.getOccupancy();
+    const BitGrid& occupied = occupancy.getOccupied();
+    const BitGrid& friendly = occupancy.getPlayerTiles(viewer);
+    const BitGrid& seen = getVisible(viewer);
+    if (knownOccupied.getWidth() != occupied.getWidth() || knownOccupied.getHeight() != occupied.getHeight()) {
+        knownOccupied = BitGrid(occupied.getWidth(), occupied.getHeight());
+    }
+    for (size_t i = 0; i < occupied.wordCount(); i++) {
+        knownOccupied.data()[i] = occupied.data()[i] & (friendly.data()[i] | seen.data()[i]);
+    }
+    out.clear();
+    const UnitPool& units = state.getUnits();
+    UnitType type = units.getType(index);
+    forUnitType(type, [&](auto unitType) {
+        floodFillRangeOf<decltype(unitType)::value>(state.getMap().getPassability(type), knownOccupied, friendly,
+                                                    units.getX(index), units.getY(index), out);
+    });
+}
+
+BitGrid& FogOfWar::grid(int player) {
+    if (player >= static_cast<int>(visible.size())) {
+        visible.resize(player + 1, BitGrid(noTiles.getWidth(), noTiles.getHeight()));
+    }
+    return visible[player];
+}
+
+void FogOfWar::refresh(const GameState& state, int player, const TileRect& rect) {
+    stats.updates++;
+    if (rect.empty()) return;
+    BitGrid& target = grid(player);
+    for (int y = rect.top; y <= rect.bottom; y++) {
+        clearBits(target.row(y), rect.left, rect.right);
+    }
+
+    // Units whose sight can reach the rect stand within MAX_SIGHT_RANGE of
+    // it: look them up through the occupancy grid, unless there are fewer
+    // units than tiles to look at
+    const UnitPool& units = state.getUnits();
+    TileRect reach = clipped({rect.left - MAX_SIGHT_RANGE, rect.top - MAX_SIGHT_RANGE,
+                              rect.right + MAX_SIGHT_RANGE, rect.bottom + MAX_SIGHT_RANGE}, state.getMap());
+    auto relight = [&](int index) {
+        if (units.getPlayer(index) != player) return;
+        int range = units.getSightRange(index), x = units.getX(index), y = units.getY(index);
+        if (x + range < rect.left || x - range > rect.right || y + range < rect.top || y - range > rect.bottom) return;
+        light(state, index, target, rect);
+    };
+    long area = static_cast<long>(reach.right - reach.left + 1) * (reach.bottom - reach.top + 1);
+    if (area > units.size()) {
+        for (int i = 0; i < units.size(); i++) {
+            relight(i);
+        }
+        return;
+    }
+    const OccupancyGrid& occupancy = state.getOccupancy();
+    for (int y = reach.top; y <= reach.bottom; y++) {
+        for (int x = reach.left; x <= reach.right; x++) {
+            int occupant = occupancy.at(x, y);
+            if (occupant != OccupancyGrid::EMPTY) relight(occupant);
+        }
+    }
+}
+
+void FogOfWar::light(const GameState& state, int index, BitGrid& target, const TileRect& rect) {
+    const UnitPool& units = state.getUnits();
+    int unitX = units.getX(index), unitY = units.getY(index);
+    uint64_t rows[SIGHT_WINDOW] = {};
+    rows[MAX_SIGHT_RANGE] = uint64_t(1) << MAX_SIGHT_RANGE;
+    SightCaster caster = {state.getMap(), unitX, unitY, units.getSightRange(index), rows};
+    for (const int* octant : OCTANTS) {
+        caster.cast(1, 1.0, 0.0, octant);
+    }
+    stats.sightsCast++;
+
+    // Window column c is map column base + c; keep the rect's columns and
+    // OR each row in, straddling at most two words
+    int base = unitX - MAX_SIGHT_RANGE;
+    int lo = rect.left - base, hi = rect.right - base;
+    if (hi < 0 || lo >= SIGHT_WINDOW) return;
+    uint64_t columns = bitRange(std::max(lo, 0), std::min(hi, 63));
+    for (int row = 0; row < SIGHT_WINDOW; row++) {
+        int y = unitY - MAX_SIGHT_RANGE + row;
+        uint64_t bits = rows[row] & columns;
+        if (!bits || y < rect.top || y > rect.bottom) continue;
+        uint64_t* words = target.row(y);
+        if (base < 0) {
+            words[0] |= bits >> -base;
+            continue;
+        }
+        int word = base >> 6, shift = base & 63;
+        words[word] |= bits << shift;
+        if (shift && (bits >> (64 - shift))) words[word + 1] |= bits >> (64 - shift);
+    }
+}
@@ -0,0 +1,298 @@
+#include "game_state.hpp"
+#include <iostream>
+
+GameState::GameState(int width, int height)
+    : map(std::make_shared<Map>(width, height)), occupancy(width, height) {}
+
+Map& GameState::ownMap() {
+    if (map.use_count() > 1) {
+        map = std::make_shared<Map>(*map);
+    }
+    return *map;
+}
+
+bool GameState::loadMap(const std::string& filename) {
+    Map& terrain = ownMap();
+    bool loaded = terrain.loadMap(filename);
+    // Binary maps bring their own size
+    if (loaded && (terrain.getWidth() != occupancy.getWidth() || terrain.getHeight() != occupancy.getHeight())) {
+        occupancy = OccupancyGrid(terrain.getWidth(), terrain.getHeight());
+        occupancy.rebuild(units);
+    }
+    reachability.invalidateAll();
+    return loaded;
+}
+
+bool GameState::loadUnits(const std::string& filename, int player) {
+    std::vector<Unit> loaded;
+    if (!::loadUnits(filename, player, loaded)) return false;
+    for (const Unit& unit : loaded) {
+        if (!onMap(unit.getX(), unit.getY())) {
+            std::cerr << "Unit outside the map at (" << unit.getX() << ", " << unit.getY() << ") in unit file: " << filename << std::endl;
+            return false;
+        }
+    }
+    // The grid holds one unit per tile; a second one there would be left out
+    BitGrid taken = occupancy.getOccupied();
+    for (const Unit& unit : loaded) {
+        if (!unit.isAlive()) continue;
+        if (taken.test(unit.getX(), unit.getY())) {
+            std::cerr << "Two units at (" << unit.getX() << ", " << unit.getY() << ") in unit file: " << filename << std::endl;
+            return false;
+        }
+        taken.set(unit.getX(), unit.getY());
+    }
+    for (const Unit& unit : loaded) {
+        if (unit.isAlive()) {
+            units.spawn(unit);
+            reserveSelection(unit);
+        }
+    }
+    occupancy.rebuild(units);
+    reachability.invalidateAll();
+    return true;
+}
+
+UnitHandle GameState::addUnit(const Unit& unit) {
+    if (!unit.isAlive() || !onMap(unit.getX(), unit.getY())) return UnitHandle();
+    UnitHandle handle = units.spawn(unit);
+    reserveSelection(unit);
+    int index = units.size() - 1;
+    occupancy.place(unit.getX(), unit.getY(), index, unit.getPlayer());
+    reachability.unitAdded(index, units);
+    return handle;
+}
+
+void GameState::reserveSelection(const Unit& unit) {
+    // Selecting any unit then copies its ranges without growing the buffers
+    int move = unit.getMoveRange(), attack = unit.getAttackRange();
+    movementRange.reserve(2 * move * (move + 1));
+    attackRange.reserve((2 * attack + 1) * (2 * attack + 1) - 1);
+}
+
+bool GameState::removeUnit(UnitHandle handle) {
+    int index = units.indexOf(handle);
+    if (index == -1) return false;
+    removeAt(index);
+    return true;
+}
+
+void GameState::removeAt(int index) {
+    int x = units.getX(index), y = units.getY(index);
+    if (onMap(x, y) && occupancy.at(x, y) == index) {
+        occupancy.clear(x, y);
+    }
+    reachability.unitRemoved(index, units);
+    if (selected == index) {
+        clearSelection();
+    }
+
+    int last = units.size() - 1;
+    units.remove(index);
+    if (index == last) return;
+    // The last unit now lives at `index`
+    int movedX = units.getX(index), movedY = units.getY(index);
+    if (onMap(movedX, movedY) && occupancy.at(movedX, movedY) == last) {
+        occupancy.place(movedX, movedY, index, units.getPlayer(index));
+    }
+    if (selected == last) selected = index;
+}
+
+void GameState::restoreAt(int index, const StepUndo& undo) {
+    Unit unit(undo.targetType, undo.result.to.x, undo.result.to.y, undo.targetPlayer, undo.targetOrientation);
+    unit.takeDamage(unit.getHealth() - undo.targetHealth);
+    units.restore(index, unit, undo.targetHandle);
+
+    int last = units.size() - 1;
+    if (index != last) {
+        // The unit that took over `index` is back at the end
+        int movedX = units.getX(last), movedY = units.getY(last);
+        if (onMap(movedX, movedY) && occupancy.at(movedX, movedY) == index) {
+            occupancy.place(movedX, movedY, last, units.getPlayer(last));
+        }
+    }
+    occupancy.place(unit.getX(), unit.getY(), index, unit.getPlayer());
+    reachability.unitRestored(index, units);
+}
+
+int GameState::unitAt(int x, int y) const {
+    if (!onMap(x, y)) return -1;
+    return occupancy.at(x, y);
+}
+
+bool GameState::findPath(int index, Point from, Point to, std::vector<Point>& path) const {
+    PathQuery query = {units.getType(index), units.getPlayer(index), from, to, units.getMoveRange(index)};
+    return pathfinder.findPath(query, *map, occupancy, path);
+}
+
+int GameState::getWinner() const {
+    bool alive[3] = {false, false, false};
+    for (int i = 0; i < units.size(); i++) {
+        int player = units.getPlayer(i);
+        if (player >= 1 && player <= 2) {
+            alive[player] = true;
+        }
+    }
+    if (alive[1] && !alive[2]) return 1;
+    if (alive[2] && !alive[1]) return 2;
+    return 0;
+}
+
+uint64_t GameState::stateHash() const {
+    // One multiply-xorshift round per 64-bit word; runs after every replayed turn
+    uint64_t hash = 0x9e3779b97f4a7c15ULL;
+    auto mix = [&hash](uint64_t value) {
+        hash = (hash ^ value) * 0xbf58476d1ce4e5b9ULL;
+        hash ^= hash >> 31;
+    };
+    mix(static_cast<uint64_t>(currentPlayer) << 32 | static_cast<uint32_t>(units.size()));
+    for (int i = 0; i < units.size(); i++) {
+        mix(static_cast<uint64_t>(static_cast<uint32_t>(units.getX(i))) << 32 | static_cast<uint32_t>(units.getY(i)));
+        mix(static_cast<uint64_t>(static_cast<uint32_t>(units.getHealth(i))) << 32 | units.getType(i) << 8 | (units.getPlayer(i) & 0xff));
+    }
+    return hash;
+}
+
+Command GameState::commandForClick(int x, int y) const {
+    int occupant = unitAt(x, y);
+    if (occupant != -1 && units.getPlayer(occupant) == currentPlayer) {
+        return {SELECT, x, y};
+    }
+    if (selected != -1) {
+        for (const Point& point : movementRange) {
+            if (point.x == x && point.y == y) {
+                return {MOVE, x, y};
+            }
+        }
+        if (occupant != -1) {
+            return {ATTACK, x, y};
+        }
+    }
+    // Not actionable; step() will report it as invalid
+    return {selected == -1 ? SELECT : MOVE, x, y};
+}
+
+StepResult GameState::step(const Command& command) {
+    StepResult result;
+
+    switch (command.type) {
+        case SELECT: {
+            int index = unitAt(command.x, command.y);
+            if (index == -1 || units.getPlayer(index) != currentPlayer) {
+                return result;
+            }
+            selected = index;
+            movementRange = reachability.movementRange(index, units, *map, occupancy);
+            attackRange = reachability.attackRange(index, units, *map);
+            result.outcome = SELECTED;
+            result.unitIndex = index;
+            result.from = result.to = {units.getX(index), units.getY(index)};
+            return result;
+        }
+        case MOVE: {
+            if (selected == -1) return result;
+            bool inRange = false;
+            for (const Point& point : movementRange) {
+                if (point.x == command.x && point.y == command.y) {
+                    inRange = true;
+                    break;
+                }
+            }
+            // Friendly units can be walked through but not stacked on
+            if (!inRange || unitAt(command.x, command.y) != -1) return result;
+
+            result.outcome = MOVED;
+            result.unitIndex = selected;
+            result.from = {units.getX(selected), units.getY(selected)};
+            result.to = {command.x, command.y};
+            occupancy.move(result.from.x, result.from.y, command.x, command.y);
+            units.setPosition(selected, command.x, command.y);
+            reachability.unitMoved(selected, units, result.from, result.to);
+            endTurn();
+            return result;
+        }
+        case ATTACK: {
+            if (selected == -1) return result;
+            bool inRange = false;
+            for (const Point& point : attackRange) {
+                if (point.x == command.x && point.y == command.y) {
+                    inRange = true;
+                    break;
+                }
+            }
+            int target = unitAt(command.x, command.y);
+            if (!inRange || target == -1 || units.getPlayer(target) == currentPlayer) {
+                return result;
+            }
+
+            if (!units.get(selected).inAttackRange(command.x, command.y)) return result;
+
+            result.outcome = ATTACKED;
+            result.unitIndex = selected;
+            result.targetIndex = target;
+            result.from = {units.getX(selected), units.getY(selected)};
+            result.to = {command.x, command.y};
+            result.damage = units.getAttackDamage(selected);
+            units.takeDamage(target, result.damage);
+            result.killed = units.getHealth(target) <= 0;
+            if (result.killed) {
+                // The last unit moves into the dead one's index
+                if (result.unitIndex == units.size() - 1) result.unitIndex = target;
+                result.targetIndex = -1;
+                removeAt(target);
+            }
+            endTurn();
+            return result;
+        }
+    }
+    return result;
+}
+
+StepResult GameState::step(const Command& command, StepUndo& undo) {
+    undo = StepUndo();
+    undo.player = currentPlayer;
+    undo.unitIndex = selected;
+    if (command.type == ATTACK) {
+        int target = unitAt(command.x, command.y);
+        undo.targetIndex = target;
+        if (target != -1) {
+            undo.targetType = units.getType(target);
+            undo.targetPlayer = units.getPlayer(target);
+            undo.targetHealth = units.getHealth(target);
+            undo.targetOrientation = units.getOrientation(target);
+            undo.targetHandle = units.handleAt(target);
+        }
+    }
+    undo.result = step(command);
+    return undo.result;
+}
+
+void GameState::undo(const StepUndo& undo) {
+    const StepResult& result = undo.result;
+    if (result.outcome == MOVED) {
+        occupancy.move(result.to.x, result.to.y, result.from.x, result.from.y);
+        units.setPosition(undo.unitIndex, result.from.x, result.from.y);
+        reachability.unitMoved(undo.unitIndex, units, result.to, result.from);
+        currentPlayer = undo.player;
+    } else if (result.outcome == ATTACKED) {
+        if (result.killed) {
+            restoreAt(undo.targetIndex, undo);
+        } else {
+            units.takeDamage(undo.targetIndex, -result.damage);
+        }
+        currentPlayer = undo.player;
+    }
+    clearSelection();
+}
+
+void GameState::clearSelection() {
+    selected = -1;
+    movementRange.clear();
+    attackRange.clear();
+}
+
+void GameState::endTurn() {
+    // End turn, reset selection, and switch players
+    clearSelection();
+    currentPlayer = (currentPlayer == 1) ? 2 : 1;
+}
@@ -0,0 +1,238 @@
+#include "map.hpp"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include "binary_layout.hpp"
+#include "mapped_file.hpp"
+
+namespace {
+
+// Whether a stored passability grid (`wordsPerRow` words per row, read from
+// file bytes) holds exactly the tiles of `terrain` that `type` can enter,
+// with the row padding past the last column clear
+bool storedGridMatches(const unsigned char* words, size_t wordsPerRow, const uint8_t* terrain, int width, int height,
+                       UnitType type) {
+    for (int y = 0; y < height; y++) {
+        for (size_t word = 0; word < wordsPerRow; word++) {
+            uint64_t stored;
+            std::memcpy(&stored, words + (y * wordsPerRow + word) * sizeof(uint64_t), sizeof(stored));
+            uint64_t expected = 0;
+            int columns = std::min(64, width - static_cast<int>(word) * 64);
+            for (int bit = 0; bit < columns; bit++) {
+                TerrainType tile = static_cast<TerrainType>(terrain[static_cast<size_t>(y) * width + word * 64 + bit]);
+                if (::isPassable(tile, type)) expected |= uint64_t(1) << bit;
+            }
+            if (stored != expected) return false;
+        }
+    }
+    return true;
+}
+
+}
+
+Map::Map(int width, int height)
+    : width(width), height(height), terrain(static_cast<size_t>(width) * height, GRASS) {
+    for (int type = 0; type < UNIT_TYPE_COUNT; type++) {
+        passability[type] = BitGrid(width, height);
+        if (::isPassable(GRASS, static_cast<UnitType>(type))) {
+            passability[type].fill();
+        }
+    }
+}
+
+void Map::setTerrain(int x, int y, TerrainType type) {
+    terrain[y * width + x] = static_cast<uint8_t>(type);
+    for (int unitType = 0; unitType < UNIT_TYPE_COUNT; unitType++) {
+        passability[unitType].assign(x, y, ::isPassable(type, static_cast<UnitType>(unitType)));
+    }
+}
+
+bool Map::measureMapFile(const std::string& filename, int& width, int& height) {
+    if (hasExtension(filename, ".bmap")) {
+        MapFileHeader header;
+        std::ifstream file(filename, std::ios::binary);
+        if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) || std::memcmp(header.magic, "BNMP", 4) != 0) {
+            std::cerr << "Not a binary map file: " << filename << std::endl;
+            return false;
+        }
+        if (header.version != BINARY_LAYOUT_VERSION) {
+            std::cerr << "Unsupported map file: " << filename << std::endl;
+            return false;
+        }
+        width = static_cast<int>(header.width);
+        height = static_cast<int>(header.height);
+        return width > 0 && height > 0;
+    }
+
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Unable to open map file: " << filename << std::endl;
+        return false;
+    }
+
+    std::string line;
+    width = 0;
+    height = 0;
+    while (std::getline(file, line)) {
+        if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+        if (height == 0) {
+            std::istringstream stream(line);
+            char tileChar;
+            while (stream >> tileChar) width++;
+        }
+        height++;
+    }
+    return width > 0 && height > 0;
+}
+
+bool Map::loadMap(const std::string& filename) {
+    if (hasExtension(filename, ".bmap")) {
+        return loadBinaryMap(filename);
+    }
+
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Unable to open map file: " << filename << std::endl;
+        return false;
+    }
+
+    // Parse file line by line
+    std::string line;
+    int y = 0;
+    while (std::getline(file, line) && y < height) {
+        std::istringstream stream(line);
+        char tileChar;
+        int x = 0;
+        while (stream >> tileChar && x < width) {
+            switch (tileChar) {
+                case 'G': setTerrain(x, y, GRASS); break;
+                case 'W': setTerrain(x, y, WATER); break;
+                case 'R': setTerrain(x, y, ROAD); break;
+                case 'M': setTerrain(x, y, MOUNTAIN); break;
+                default: setTerrain(x, y, GRASS); break; // Default to grass
+            }
+            x++;
+        }
+        y++;
+    }
+
+    return true;
+}
+
+bool Map::loadBinaryMap(const std::string& filename) {
+    MappedFile file;
+    if (!file.open(filename)) {
+        std::cerr << "Unable to open map file: " << filename << std::endl;
+        return false;
+    }
+
+    MapFileHeader header;
+    if (file.size() < sizeof(header)) {
+        std::cerr << "Truncated map file: " << filename << std::endl;
+        return false;
+    }
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, "BNMP", 4) != 0 || header.version != BINARY_LAYOUT_VERSION) {
+        std::cerr << "Unsupported map file: " << filename << std::endl;
+        return false;
+    }
+
+    // Dimensions fit an int, so the products below can't overflow either
+    if (header.width > static_cast<uint32_t>(INT_MAX) || header.height > static_cast<uint32_t>(INT_MAX)) {
+        std::cerr << "Corrupt map size in map file: " << filename << std::endl;
+        return false;
+    }
+    size_t tileCount = static_cast<size_t>(header.width) * header.height;
+    size_t expectedWords = (header.width + 63) / 64;
+    size_t gridBytes = expectedWords * header.height * sizeof(uint64_t);
+    bool storedGrids = header.unitTypeCount == UNIT_TYPE_COUNT && header.wordsPerRow == expectedWords;
+    if (!fitsInFile(header.terrainOffset, tileCount, file.size()) ||
+        (storedGrids && !fitsInFile(header.passabilityOffset, gridBytes * UNIT_TYPE_COUNT, file.size()))) {
+        std::cerr << "Truncated map file: " << filename << std::endl;
+        return false;
+    }
+
+    const uint8_t* terrainBytes = file.data() + header.terrainOffset;
+    for (size_t i = 0; i < tileCount; i++) {
+        if (terrainBytes[i] >= TERRAIN_TYPE_COUNT) {
+            std::cerr << "Corrupt terrain in map file: " << filename << std::endl;
+            return false;
+        }
+    }
+    // Stored grids are copied as they are, so they must agree with the terrain
+    for (int type = 0; storedGrids && type < UNIT_TYPE_COUNT; type++) {
+        if (!storedGridMatches(file.data() + header.passabilityOffset + gridBytes * type, expectedWords, terrainBytes,
+                               static_cast<int>(header.width), static_cast<int>(header.height), static_cast<UnitType>(type))) {
+            std::cerr << "Corrupt passability in map file: " << filename << std::endl;
+            return false;
+        }
+    }
+
+    width = static_cast<int>(header.width);
+    height = static_cast<int>(header.height);
+    terrain.assign(terrainBytes, terrainBytes + tileCount);
+    for (int type = 0; type < UNIT_TYPE_COUNT; type++) {
+        passability[type] = BitGrid(width, height);
+        if (storedGrids) {
+            std::memcpy(passability[type].data(), file.data() + header.passabilityOffset + gridBytes * type, gridBytes);
+        }
+    }
+    if (!storedGrids) {
+        // Written by a build with other unit types; derive the grids from terrain
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                setTerrain(x, y, getTerrain(x, y));
+            }
+        }
+    }
+    return true;
+}
+
+bool Map::saveMap(const std::string& filename) const {
+    static const char symbols[TERRAIN_TYPE_COUNT] = {'G', 'W', 'R', 'M'};
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Unable to write map file: " << filename << std::endl;
+        return false;
+    }
+    std::string line;
+    for (int y = 0; y < height; y++) {
+        line.clear();
+        for (int x = 0; x < width; x++) {
+            if (x > 0) line += ' ';
+            line += symbols[getTerrain(x, y)];
+        }
+        file << line << '\n';
+    }
+    return static_cast<bool>(file);
+}
+
+bool Map::saveBinaryMap(const std::string& filename) const {
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Unable to write map file: " << filename << std::endl;
+        return false;
+    }
+
+    MapFileHeader header = {};
+    std::memcpy(header.magic, "BNMP", 4);
+    header.version = BINARY_LAYOUT_VERSION;
+    header.width = static_cast<uint32_t>(width);
+    header.height = static_cast<uint32_t>(height);
+    header.wordsPerRow = static_cast<uint32_t>(passability[0].getWordsPerRow());
+    header.unitTypeCount = UNIT_TYPE_COUNT;
+    header.terrainOffset = sizeof(MapFileHeader);
+    header.passabilityOffset = (header.terrainOffset + terrain.size() + 7) & ~uint64_t(7);
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(terrain.data()), terrain.size());
+    static const char padding[8] = {};
+    file.write(padding, header.passabilityOffset - header.terrainOffset - terrain.size());
+    for (int type = 0; type < UNIT_TYPE_COUNT; type++) {
+        file.write(reinterpret_cast<const char*>(passability[type].data()), passability[type].wordCount() * sizeof(uint64_t));
+    }
+    return static_cast<bool>(file);
+}
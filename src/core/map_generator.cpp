@@ -0,0 +1,48 @@
+#include "map_generator.hpp"
+#include <cstdint>
+#include <random>
+
+namespace {
+
+const int NOISE_CELL = 8;      // tiles per noise lattice cell
+const int ROAD_SPACING = 24;   // tiles between roads
+
+// Deterministic value in [0, 1) for a lattice point
+double latticeValue(int x, int y, unsigned seed) {
+    uint32_t h = static_cast<uint32_t>(x) * 374761393u + static_cast<uint32_t>(y) * 668265263u + seed * 2246822519u;
+    h = (h ^ (h >> 13)) * 1274126177u;
+    h ^= h >> 16;
+    return (h & 0xFFFFFF) / static_cast<double>(0x1000000);
+}
+
+double smoothNoise(int x, int y, unsigned seed) {
+    int cellX = x / NOISE_CELL, cellY = y / NOISE_CELL;
+    double fx = (x % NOISE_CELL) / static_cast<double>(NOISE_CELL);
+    double fy = (y % NOISE_CELL) / static_cast<double>(NOISE_CELL);
+    double top = latticeValue(cellX, cellY, seed) * (1 - fx) + latticeValue(cellX + 1, cellY, seed) * fx;
+    double bottom = latticeValue(cellX, cellY + 1, seed) * (1 - fx) + latticeValue(cellX + 1, cellY + 1, seed) * fx;
+    return top * (1 - fy) + bottom * fy;
+}
+
+}
+
+void generateTerrain(Map& map, unsigned seed) {
+    std::mt19937 rng(seed);
+    int roadOffsetX = static_cast<int>(rng() % ROAD_SPACING);
+    int roadOffsetY = static_cast<int>(rng() % ROAD_SPACING);
+
+    for (int y = 0; y < map.getHeight(); y++) {
+        for (int x = 0; x < map.getWidth(); x++) {
+            double height = smoothNoise(x, y, seed);
+            TerrainType type = GRASS;
+            if (height < 0.25) {
+                type = WATER;
+            } else if (height > 0.78) {
+                type = MOUNTAIN;
+            } else if ((x % ROAD_SPACING) == roadOffsetX || (y % ROAD_SPACING) == roadOffsetY) {
+                type = ROAD;
+            }
+            map.setTerrain(x, y, type);
+        }
+    }
+}
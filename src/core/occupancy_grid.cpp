@@ -0,0 +1,54 @@
+#include "occupancy_grid.hpp"
+#include <algorithm>
+
+OccupancyGrid::OccupancyGrid(int width, int height)
+    : width(width), height(height), slots(width * height, EMPTY),
+      occupied(width, height), noTiles(width, height) {}
+
+void OccupancyGrid::rebuild(const UnitPool& units) {
+    std::fill(slots.begin(), slots.end(), EMPTY);
+    occupied.clear();
+    for (BitGrid& tiles : playerTiles) {
+        tiles.clear();
+    }
+    for (int i = 0; i < units.size(); i++) {
+        int x = units.getX(i), y = units.getY(i);
+        if (x >= 0 && y >= 0 && x < width && y < height) {
+            place(x, y, i, units.getPlayer(i));
+        }
+    }
+}
+
+void OccupancyGrid::place(int x, int y, int slot, int player) {
+    if (at(x, y) != EMPTY) clear(x, y);
+    slots[y * width + x] = slot;
+    occupied.set(x, y);
+    if (player < 0) return;
+    if (player >= static_cast<int>(playerTiles.size())) {
+        playerTiles.resize(player + 1, BitGrid(width, height));
+    }
+    playerTiles[player].set(x, y);
+}
+
+void OccupancyGrid::clear(int x, int y) {
+    slots[y * width + x] = EMPTY;
+    occupied.reset(x, y);
+    for (BitGrid& tiles : playerTiles) {
+        tiles.reset(x, y);
+    }
+}
+
+void OccupancyGrid::move(int fromX, int fromY, int toX, int toY) {
+    int slot = at(fromX, fromY);
+    int player = -1;
+    for (size_t i = 0; i < playerTiles.size(); i++) {
+        if (playerTiles[i].test(fromX, fromY)) player = static_cast<int>(i);
+    }
+    clear(fromX, fromY);
+    place(toX, toY, slot, player);
+}
+
+const BitGrid& OccupancyGrid::getPlayerTiles(int player) const {
+    if (player < 0 || player >= static_cast<int>(playerTiles.size())) return noTiles;
+    return playerTiles[player];
+}
@@ -0,0 +1,167 @@
+#include "pathfinder.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include "profiler.hpp"
+
+MoveCosts MoveCosts::uniform() {
+    MoveCosts table;
+    for (int type = 0; type < UNIT_TYPE_COUNT; type++) {
+        for (int terrain = 0; terrain < TERRAIN_TYPE_COUNT; terrain++) {
+            table.cost[type][terrain] = isPassable(static_cast<TerrainType>(terrain), static_cast<UnitType>(type)) ? 1 : 0;
+        }
+    }
+    return table;
+}
+
+Pathfinder::Pathfinder(const MoveCosts& costs) {
+    setCosts(costs);
+}
+
+void Pathfinder::setCosts(const MoveCosts& newCosts) {
+    costs = newCosts;
+    // Cheapest step per unit type, for the heuristic and the search window
+    for (int type = 0; type < UNIT_TYPE_COUNT; type++) {
+        minCost[type] = 0;
+        for (int terrain = 0; terrain < TERRAIN_TYPE_COUNT; terrain++) {
+            int cost = costs.cost[type][terrain];
+            if (cost > 0 && (minCost[type] == 0 || cost < minCost[type])) minCost[type] = cost;
+        }
+    }
+}
+
+void Pathfinder::search(const PathQuery& query, const Map& map, const OccupancyGrid& occupancy, bool toGoal) {
+    lastExpanded = 0;
+    int stepCost = minCost[query.type];
+    if (query.maxCost >= 0 && stepCost > 0) {
+        int radius = query.maxCost / stepCost;
+        windowX = std::max(0, query.from.x - radius);
+        windowY = std::max(0, query.from.y - radius);
+        windowWidth = std::min(map.getWidth() - 1, query.from.x + radius) - windowX + 1;
+        windowHeight = std::min(map.getHeight() - 1, query.from.y + radius) - windowY + 1;
+    } else {
+        windowX = windowY = 0;
+        windowWidth = map.getWidth();
+        windowHeight = map.getHeight();
+    }
+
+    size_t area = static_cast<size_t>(windowWidth) * windowHeight;
+    if (area > visitMark.size()) {
+        bestCost.resize(area);
+        parent.resize(area);
+        visitMark.assign(area, 0);
+        generation = 0;
+    }
+    if (++generation == 0) {
+        std::fill(visitMark.begin(), visitMark.end(), 0);
+        generation = 1;
+    }
+    open.clear();
+
+    const BitGrid& occupied = occupancy.getOccupied();
+    const BitGrid& friendly = occupancy.getPlayerTiles(query.player);
+    // Among equal estimates expand the node furthest along first
+    auto lowerPriority = [](const OpenNode& a, const OpenNode& b) {
+        return a.estimate > b.estimate || (a.estimate == b.estimate && a.cost < b.cost);
+    };
+    auto heuristic = [&](int x, int y) {
+        return toGoal ? stepCost * (std::abs(x - query.to.x) + std::abs(y - query.to.y)) : 0;
+    };
+
+    int start = (query.from.y - windowY) * windowWidth + (query.from.x - windowX);
+    int goal = (query.to.y - windowY) * windowWidth + (query.to.x - windowX);
+    bestCost[start] = 0;
+    parent[start] = -1;
+    visitMark[start] = generation;
+    open.push_back({heuristic(query.from.x, query.from.y), 0, start});
+
+    const int directions[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+    while (!open.empty()) {
+        std::pop_heap(open.begin(), open.end(), lowerPriority);
+        OpenNode node = open.back();
+        open.pop_back();
+        if (node.cost > bestCost[node.index]) continue;  // superseded entry
+        lastExpanded++;
+        if (toGoal && node.index == goal) break;
+
+        int x = windowX + node.index % windowWidth;
+        int y = windowY + node.index / windowWidth;
+        for (const auto& direction : directions) {
+            int nx = x + direction[0];
+            int ny = y + direction[1];
+            if (nx < windowX || ny < windowY || nx >= windowX + windowWidth || ny >= windowY + windowHeight) continue;
+            int cost = costs.cost[query.type][map.getTerrain(nx, ny)];
+            if (cost == 0 || (occupied.test(nx, ny) && !friendly.test(nx, ny))) continue;
+
+            int newCost = node.cost + cost;
+            int estimate = newCost + heuristic(nx, ny);
+            // The estimate never overshoots, so this node can't lead to the goal in time
+            if (query.maxCost >= 0 && estimate > query.maxCost) continue;
+            int next = (ny - windowY) * windowWidth + (nx - windowX);
+            if (visitMark[next] == generation && bestCost[next] <= newCost) continue;
+            visitMark[next] = generation;
+            bestCost[next] = newCost;
+            parent[next] = node.index;
+            open.push_back({estimate, newCost, next});
+            std::push_heap(open.begin(), open.end(), lowerPriority);
+        }
+    }
+}
+
+bool Pathfinder::reconstruct(const PathQuery& query, std::vector<Point>& path) const {
+    path.clear();
+    if (query.to.x < windowX || query.to.y < windowY || query.to.x >= windowX + windowWidth || query.to.y >= windowY + windowHeight) {
+        return false;
+    }
+    int index = (query.to.y - windowY) * windowWidth + (query.to.x - windowX);
+    if (visitMark[index] != generation) return false;
+    for (; index != -1; index = parent[index]) {
+        path.push_back({windowX + index % windowWidth, windowY + index / windowWidth});
+    }
+    std::reverse(path.begin(), path.end());
+    return true;
+}
+
+bool Pathfinder::findPath(const PathQuery& query, const Map& map, const OccupancyGrid& occupancy, std::vector<Point>& path) {
+    BATTLE_PROFILE_SCOPE("find_path");
+    path.clear();
+    if (query.from.x < 0 || query.from.y < 0 || query.from.x >= map.getWidth() || query.from.y >= map.getHeight()) return false;
+    if (query.to.x < 0 || query.to.y < 0 || query.to.x >= map.getWidth() || query.to.y >= map.getHeight()) return false;
+    int stepCost = minCost[query.type];
+    int distance = std::abs(query.to.x - query.from.x) + std::abs(query.to.y - query.from.y);
+    // Unit types that can't enter any terrain only "reach" their own tile
+    if (stepCost == 0 && distance > 0) return false;
+    if (query.maxCost >= 0 && distance * stepCost > query.maxCost) return false;
+    search(query, map, occupancy, true);
+    return reconstruct(query, path);
+}
+
+int Pathfinder::findPaths(const std::vector<PathQuery>& queries, const Map& map, const OccupancyGrid& occupancy,
+                          std::vector<std::vector<Point>>& paths) {
+    paths.resize(queries.size());
+    int found = 0;
+    size_t i = 0;
+    while (i < queries.size()) {
+        const PathQuery& first = queries[i];
+        size_t end = i + 1;
+        while (end < queries.size() && queries[end].type == first.type && queries[end].player == first.player &&
+               queries[end].from.x == first.from.x && queries[end].from.y == first.from.y && queries[end].maxCost == first.maxCost) {
+            end++;
+        }
+        if (end - i == 1) {
+            found += findPath(first, map, occupancy, paths[i]);
+            i = end;
+            continue;
+        }
+
+        bool validStart = first.from.x >= 0 && first.from.y >= 0 && first.from.x < map.getWidth() && first.from.y < map.getHeight();
+        if (validStart) search(first, map, occupancy, false);
+        for (; i < end; i++) {
+            if (validStart) {
+                found += reconstruct(queries[i], paths[i]);
+            } else {
+                paths[i].clear();
+            }
+        }
+    }
+    return found;
+}
@@ -0,0 +1,200 @@
+#include "profiler.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include "allocation_counter.hpp"
+
+namespace {
+
+const double AVERAGE_WEIGHT = 0.1;  // of the newest frame in the smoothed section times
+const auto epoch = std::chrono::steady_clock::now();
+
+uint32_t threadNumber() {
+    static std::atomic<uint32_t> nextThread{1};
+    thread_local uint32_t number = nextThread++;
+    return number;
+}
+
+double percentile(const std::vector<double>& sorted, double fraction) {
+    size_t index = static_cast<size_t>(fraction * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+}
+
+Profiler& Profiler::instance() {
+    static Profiler profiler;
+    return profiler;
+}
+
+uint64_t Profiler::nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+// A thread's hold on one ThreadEvents; an exiting thread leaves its events
+// to be exported and its ring to the next new thread
+struct Profiler::ThreadLease {
+    ThreadEvents* buffer = nullptr;
+
+    ~ThreadLease() {
+        if (!buffer) return;
+        Profiler& profiler = Profiler::instance();
+        std::lock_guard<std::mutex> lock(profiler.mutex);
+        profiler.spareThreadEvents.push_back(buffer);
+    }
+};
+
+void Profiler::setEnabled(bool value) {
+    enabled.store(value, std::memory_order_relaxed);
+}
+
+Profiler::ThreadEvents& Profiler::ownEvents() {
+    thread_local ThreadLease lease;
+    if (lease.buffer) return *lease.buffer;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!spareThreadEvents.empty()) {
+        lease.buffer = spareThreadEvents.back();
+        spareThreadEvents.pop_back();
+    } else {
+        threadEvents.push_back(std::make_unique<ThreadEvents>());
+        lease.buffer = threadEvents.back().get();
+        lease.buffer->events.resize(MAX_THREAD_EVENTS);
+    }
+    return *lease.buffer;
+}
+
+void Profiler::push(ThreadEvents& buffer, const ProfileEvent& event) {
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    buffer.events[buffer.next] = event;
+    buffer.next = (buffer.next + 1) % buffer.events.size();
+    buffer.count = std::min(buffer.count + 1, buffer.events.size());
+}
+
+void Profiler::record(const char* name, uint64_t startNs, uint64_t endNs) {
+    uint32_t thread = threadNumber();
+    push(ownEvents(), {name, startNs, endNs - startNs, thread});
+    if (thread != frameThread.load(std::memory_order_relaxed)) return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto section = std::find_if(sections.begin(), sections.end(), [name](const Section& s) { return std::strcmp(s.name, name) == 0; });
+    if (section == sections.end()) {
+        sections.push_back(Section());
+        section = sections.end() - 1;
+        section->name = name;
+    }
+    section->frameNs += endNs - startNs;
+    section->frameCalls++;
+}
+
+void Profiler::beginFrame() {
+    frameThread.store(threadNumber(), std::memory_order_relaxed);
+    frameStartNs = nowNs();
+    frameStartAllocations = threadAllocationStats().allocations;
+}
+
+void Profiler::endFrame(int drawCalls) {
+    uint64_t endNs = nowNs();
+    uint64_t allocations = threadAllocationStats().allocations - frameStartAllocations;
+    if (!isEnabled()) return;
+    push(ownEvents(), {"frame", frameStartNs, endNs - frameStartNs, threadNumber()});
+    std::lock_guard<std::mutex> lock(mutex);
+    lastAllocations = allocations;
+
+    double ms = (endNs - frameStartNs) / 1e6;
+    if (frameMs.size() < FRAME_HISTORY) {
+        frameMs.push_back(ms);
+    } else {
+        frameMs[nextFrame] = ms;
+    }
+    nextFrame = (nextFrame + 1) % FRAME_HISTORY;
+    lastDrawCalls = drawCalls;
+
+    for (Section& section : sections) {
+        section.lastMs = section.frameNs / 1e6;
+        section.lastCalls = section.frameCalls;
+        section.averageMs += AVERAGE_WEIGHT * (section.lastMs - section.averageMs);
+        section.frameNs = 0;
+        section.frameCalls = 0;
+    }
+}
+
+FrameTimings Profiler::getFrameTimings() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    FrameTimings timings;
+    timings.drawCalls = lastDrawCalls;
+    timings.allocations = lastAllocations;
+    if (frameMs.empty()) return timings;
+
+    timings.frames = static_cast<int>(frameMs.size());
+    timings.lastMs = frameMs[(nextFrame + FRAME_HISTORY - 1) % FRAME_HISTORY];
+    sortedFrameMs.assign(frameMs.begin(), frameMs.end());
+    std::sort(sortedFrameMs.begin(), sortedFrameMs.end());
+    timings.p50Ms = percentile(sortedFrameMs, 0.50);
+    timings.p95Ms = percentile(sortedFrameMs, 0.95);
+    timings.p99Ms = percentile(sortedFrameMs, 0.99);
+    timings.maxMs = sortedFrameMs.back();
+    return timings;
+}
+
+std::vector<SectionTiming> Profiler::getSectionTimings() const {
+    std::vector<SectionTiming> timings;
+    getSectionTimings(timings);
+    return timings;
+}
+
+void Profiler::getSectionTimings(std::vector<SectionTiming>& timings) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    timings.clear();
+    for (const Section& section : sections) {
+        timings.push_back({section.name, section.lastMs, section.averageMs, section.lastCalls});
+    }
+}
+
+bool Profiler::exportChromeTrace(const std::string& filename) const {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Unable to write trace file: " << filename << std::endl;
+        return false;
+    }
+
+    // Every thread's ring, merged in time order
+    std::vector<ProfileEvent> merged;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const std::unique_ptr<ThreadEvents>& buffer : threadEvents) {
+            std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+            size_t first = (buffer->next + buffer->events.size() - buffer->count) % buffer->events.size();
+            for (size_t i = 0; i < buffer->count; i++) {
+                merged.push_back(buffer->events[(first + i) % buffer->events.size()]);
+            }
+        }
+    }
+    std::sort(merged.begin(), merged.end(), [](const ProfileEvent& a, const ProfileEvent& b) { return a.startNs < b.startNs; });
+
+    file << std::fixed << std::setprecision(3) << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+    for (size_t i = 0; i < merged.size(); i++) {
+        const ProfileEvent& event = merged[i];
+        file << (i == 0 ? "\n" : ",\n")
+             << "{\"name\": \"" << event.name << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << event.thread
+             << ", \"ts\": " << event.startNs / 1000.0 << ", \"dur\": " << event.durationNs / 1000.0 << "}";
+    }
+    file << "\n]}" << std::endl;
+    std::cout << "Wrote " << merged.size() << " trace events to " << filename << std::endl;
+    return static_cast<bool>(file);
+}
+
+void Profiler::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const std::unique_ptr<ThreadEvents>& buffer : threadEvents) {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        buffer->next = buffer->count = 0;
+    }
+    sections.clear();
+    frameMs.clear();
+    nextFrame = 0;
+}
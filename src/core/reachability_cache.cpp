@@ -0,0 +1,131 @@
+#include "reachability_cache.hpp"
+#include <algorithm>
+#include <cstdlib>
+
+ReachabilityCache& ReachabilityCache::operator=(const ReachabilityCache& other) {
+    if (entries.size() < other.entries.size()) {
+        entries.resize(other.entries.size());
+    }
+    for (size_t i = 0; i < other.entries.size(); i++) {
+        entries[i] = other.entries[i];
+    }
+    for (size_t i = other.entries.size(); i < entries.size(); i++) {
+        forget(entries[i]);
+    }
+    stats = other.stats;
+    return *this;
+}
+
+void ReachabilityCache::forget(Entry& cached) {
+    cached.movementValid = cached.attackValid = false;
+    cached.movementComputed = cached.attackComputed = false;
+}
+
+ReachabilityCache::Entry& ReachabilityCache::entry(int index) {
+    if (index >= static_cast<int>(entries.size())) {
+        entries.resize(index + 1);
+    }
+    return entries[index];
+}
+
+const std::vector<Point>& ReachabilityCache::movementRange(int index, const UnitPool& units, const Map& map,
+                                                          const OccupancyGrid& occupancy) {
+    Entry& cached = entry(index);
+    if (cached.movementValid) {
+        stats.hits++;
+        return cached.movement;
+    }
+    if (cached.movementComputed) {
+        stats.recomputes++;
+    } else {
+        stats.misses++;
+        // Room for every tile any type can reach, so recomputes never grow
+        // it, nor does a unit of another type inheriting the buffer
+        cached.movement.reserve(2 * MAX_MOVE_RANGE * (MAX_MOVE_RANGE + 1));
+    }
+    // Into the entry's own buffer, which keeps its capacity across recomputes
+    calculateMovementRange(units.get(index), map, occupancy, cached.movement);
+    cached.movementValid = cached.movementComputed = true;
+    return cached.movement;
+}
+
+const std::vector<Point>& ReachabilityCache::attackRange(int index, const UnitPool& units, const Map& map) {
+    Entry& cached = entry(index);
+    if (cached.attackValid) {
+        stats.hits++;
+        return cached.attack;
+    }
+    if (cached.attackComputed) {
+        stats.recomputes++;
+    } else {
+        stats.misses++;
+        cached.attack.reserve((2 * MAX_ATTACK_RANGE + 1) * (2 * MAX_ATTACK_RANGE + 1) - 1);
+    }
+    calculateAttackRange(units.get(index), map, cached.attack);
+    cached.attackValid = cached.attackComputed = true;
+    return cached.attack;
+}
+
+void ReachabilityCache::invalidate(int index, bool attackToo) {
+    if (index >= static_cast<int>(entries.size())) return;
+    Entry& cached = entries[index];
+    if (cached.movementValid) {
+        cached.movementValid = false;
+        stats.invalidations++;
+    }
+    if (attackToo && cached.attackValid) {
+        cached.attackValid = false;
+        stats.invalidations++;
+    }
+}
+
+void ReachabilityCache::invalidateAround(Point tile, int mover, const UnitPool& units) {
+    int player = units.getPlayer(mover);
+    int count = std::min(units.size(), static_cast<int>(entries.size()));
+    for (int i = 0; i < count; i++) {
+        if (!entries[i].movementValid || units.getPlayer(i) == player) continue;
+        int distance = std::abs(units.getX(i) - tile.x) + std::abs(units.getY(i) - tile.y);
+        if (distance <= units.getMoveRange(i)) {
+            invalidate(i, false);
+        }
+    }
+}
+
+void ReachabilityCache::unitMoved(int index, const UnitPool& units, Point from, Point to) {
+    invalidate(index, true);
+    invalidateAround(from, index, units);
+    invalidateAround(to, index, units);
+}
+
+void ReachabilityCache::unitAdded(int index, const UnitPool& units) {
+    invalidate(index, true);
+    invalidateAround({units.getX(index), units.getY(index)}, index, units);
+}
+
+void ReachabilityCache::unitRemoved(int index, const UnitPool& units) {
+    invalidateAround({units.getX(index), units.getY(index)}, index, units);
+    int last = units.size() - 1;
+    if (index >= static_cast<int>(entries.size())) return;
+    if (last < static_cast<int>(entries.size())) {
+        std::swap(entries[index], entries[last]);
+        forget(entries[last]);
+    } else {
+        forget(entries[index]);
+    }
+}
+
+void ReachabilityCache::unitRestored(int index, const UnitPool& units) {
+    int last = units.size() - 1;
+    if (index < static_cast<int>(entries.size())) {
+        // The moved unit's entry goes back with it
+        if (last < static_cast<int>(entries.size())) std::swap(entries[index], entries[last]);
+        forget(entries[index]);
+    }
+    invalidateAround({units.getX(index), units.getY(index)}, index, units);
+}
+
+void ReachabilityCache::invalidateAll() {
+    for (size_t i = 0; i < entries.size(); i++) {
+        invalidate(static_cast<int>(i), true);
+    }
+}
@@ -0,0 +1,220 @@
+#include "rules.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include "binary_layout.hpp"
+#include "flood_fill.hpp"
+#include "mapped_file.hpp"
+#include "profiler.hpp"
+#include "sprite_catalog.hpp"
+
+namespace {
+
+// BFS-based range calculation. The range and what the type may enter come
+// from UNIT_TRAITS at compile time, so the loop has no per-type branches.
+template <UnitType type>
+void movementRangeScan(const Unit& unit, const Map& map, const UnitPool& units, std::vector<Point>& out) {
+    constexpr int maxRange = UNIT_TRAITS[type].moveRange;
+
+    // Nothing beyond maxRange steps can be reached, so the visited grid and
+    // the queue only need to cover the window around the unit
+    constexpr int size = 2 * maxRange + 1;
+    int originX = unit.getX() - maxRange, originY = unit.getY() - maxRange;
+    int visited[size * size];
+    std::fill(visited, visited + size * size, -1);
+    Point toVisit[size * size];
+    int head = 0, tail = 0;
+    toVisit[tail++] = {unit.getX(), unit.getY()};
+    visited[maxRange * size + maxRange] = 0;
+
+    static const int directions[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+    while (head < tail) {
+        Point current = toVisit[head++];
+        int distance = visited[(current.y - originY) * size + (current.x - originX)];
+
+        if (distance >= maxRange) continue;
+
+        for (const auto& direction : directions) {
+            int nx = current.x + direction[0];
+            int ny = current.y + direction[1];
+            if (nx < 0 || ny < 0 || nx >= map.getWidth() || ny >= map.getHeight()) continue;
+            int& seen = visited[(ny - originY) * size + (nx - originX)];
+            if (seen != -1) continue;
+
+            if (!isPassable(map.getTerrain(nx, ny), type)) continue;
+
+            // Check if the tile is occupied by an enemy unit
+            bool occupiedByEnemy = false;
+            for (int i = 0; i < units.size(); i++) {
+                if (units.getX(i) == nx && units.getY(i) == ny && units.getPlayer(i) != unit.getPlayer()) {
+                    occupiedByEnemy = true;
+                    break;
+                }
+            }
+
+            if (!occupiedByEnemy) {
+                seen = distance + 1;
+                toVisit[tail++] = {nx, ny};
+                out.push_back({nx, ny});
+            }
+        }
+    }
+}
+
+// Every tile within the attack range, diagonals included
+template <UnitType type>
+void attackRangeOf(const Unit& unit, const Map& map, std::vector<Point>& out) {
+    constexpr int maxRange = UNIT_TRAITS[type].attackRange;
+    int left = std::max(unit.getX() - maxRange, 0), right = std::min(unit.getX() + maxRange, map.getWidth() - 1);
+    int top = std::max(unit.getY() - maxRange, 0), bottom = std::min(unit.getY() + maxRange, map.getHeight() - 1);
+    for (int nx = left; nx <= right; nx++) {
+        for (int ny = top; ny <= bottom; ny++) {
+            if (nx != unit.getX() || ny != unit.getY()) out.push_back({nx, ny});
+        }
+    }
+}
+
+}
+
+void calculateMovementRange(const Unit& unit, const Map& map, const UnitPool& units, std::vector<Point>& out) {
+    out.clear();
+    forUnitType(unit.getType(), [&](auto type) { movementRangeScan<decltype(type)::value>(unit, map, units, out); });
+}
+
+void calculateMovementRange(const Unit& unit, const Map& map, const OccupancyGrid& occupancy, std::vector<Point>& out) {
+    BATTLE_PROFILE_SCOPE("movement_range");
+    out.clear();
+#ifdef BATTLE_SCALAR_FLOODFILL
+    floodFillRangeScalar(map.getPassability(unit.getType()), occupancy.getOccupied(), occupancy.getPlayerTiles(unit.getPlayer()),
+                         unit.getX(), unit.getY(), unit.getMoveRange(), out);
+#else
+    forUnitType(unit.getType(), [&](auto type) {
+        floodFillRangeOf<decltype(type)::value>(map.getPassability(unit.getType()), occupancy.getOccupied(),
+                                                occupancy.getPlayerTiles(unit.getPlayer()), unit.getX(), unit.getY(), out);
+    });
+#endif
+}
+
+void calculateAttackRange(const Unit& unit, const Map& map, std::vector<Point>& out) {
+    BATTLE_PROFILE_SCOPE("attack_range");
+    out.clear();
+    forUnitType(unit.getType(), [&](auto type) { attackRangeOf<decltype(type)::value>(unit, map, out); });
+}
+
+std::vector<Point> calculateMovementRange(const Unit& unit, const Map& map, const UnitPool& units) {
+    std::vector<Point> rangePoints;
+    calculateMovementRange(unit, map, units, rangePoints);
+    return rangePoints;
+}
+
+std::vector<Point> calculateMovementRange(const Unit& unit, const Map& map, const OccupancyGrid& occupancy) {
+    std::vector<Point> rangePoints;
+    calculateMovementRange(unit, map, occupancy, rangePoints);
+    return rangePoints;
+}
+
+std::vector<Point> calculateAttackRange(const Unit& unit, const Map& map) {
+    std::vector<Point> rangePoints;
+    calculateAttackRange(unit, map, rangePoints);
+    return rangePoints;
+}
+
+bool loadUnits(const std::string& filename, int player, std::vector<Unit>& units) {
+    if (hasExtension(filename, ".bunits")) {
+        return loadBinaryUnits(filename, units);
+    }
+
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Unable to open unit file: " << filename << std::endl;
+        return false;
+    }
+
+    char unitTypeChar;
+    int x, y, orientation;
+
+    while (file >> unitTypeChar >> x >> y >> orientation) {
+        UnitType type;
+        switch (unitTypeChar) {
+            case 'I': type = INFANTRY; break;
+            case 'T': type = TANK; break;
+            case 'B': type = BOAT; break;
+            case 'H': type = HELICOPTER; break;
+            default:
+                continue;
+        }
+        if (orientation < 0 || orientation >= UNIT_ORIENTATIONS) {
+            std::cerr << "Bad orientation " << orientation << " in unit file: " << filename << std::endl;
+            return false;
+        }
+
+        units.emplace_back(type, x, y, player, orientation);
+    }
+
+    return true;
+}
+
+bool loadBinaryUnits(const std::string& filename, std::vector<Unit>& units) {
+    MappedFile file;
+    if (!file.open(filename)) {
+        std::cerr << "Unable to open unit file: " << filename << std::endl;
+        return false;
+    }
+
+    UnitsFileHeader header;
+    if (file.size() < sizeof(header)) {
+        std::cerr << "Truncated unit file: " << filename << std::endl;
+        return false;
+    }
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, "BNUL", 4) != 0 || header.version != BINARY_LAYOUT_VERSION ||
+        header.recordSize != sizeof(UnitRecord)) {
+        std::cerr << "Unsupported unit file: " << filename << std::endl;
+        return false;
+    }
+    if (sizeof(header) + static_cast<size_t>(header.count) * sizeof(UnitRecord) > file.size()) {
+        std::cerr << "Truncated unit file: " << filename << std::endl;
+        return false;
+    }
+
+    units.reserve(units.size() + header.count);
+    const unsigned char* records = file.data() + sizeof(header);
+    for (uint32_t i = 0; i < header.count; i++) {
+        UnitRecord record;
+        std::memcpy(&record, records + i * sizeof(UnitRecord), sizeof(record));
+        if (record.type >= UNIT_TYPE_COUNT) continue;
+        if ((record.player != 1 && record.player != 2) || record.orientation >= UNIT_ORIENTATIONS) {
+            std::cerr << "Corrupt unit record " << i << " in unit file: " << filename << std::endl;
+            return false;
+        }
+        units.emplace_back(static_cast<UnitType>(record.type), record.x, record.y, record.player, record.orientation);
+    }
+    return true;
+}
+
+bool saveBinaryUnits(const std::vector<Unit>& units, const std::string& filename) {
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Unable to write unit file: " << filename << std::endl;
+        return false;
+    }
+
+    UnitsFileHeader header = {};
+    std::memcpy(header.magic, "BNUL", 4);
+    header.version = BINARY_LAYOUT_VERSION;
+    header.count = static_cast<uint32_t>(units.size());
+    header.recordSize = sizeof(UnitRecord);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    for (const Unit& unit : units) {
+        UnitRecord record = {};
+        record.type = static_cast<uint8_t>(unit.getType());
+        record.player = static_cast<uint8_t>(unit.getPlayer());
+        record.orientation = static_cast<uint8_t>(unit.getOrientation());
+        record.x = unit.getX();
+        record.y = unit.getY();
+        file.write(reinterpret_cast<const char*>(&record), sizeof(record));
+    }
+    return static_cast<bool>(file);
+}
@@ -0,0 +1,82 @@
+#include "sprite_catalog.hpp"
+
+namespace {
+
+const char* terrainName(TerrainType type) {
+    switch (type) {
+        case GRASS: return "grass";
+        case WATER: return "water";
+        case ROAD: return "road";
+        case MOUNTAIN: return "mountain";
+    }
+    return "unknown";
+}
+
+const char* unitName(UnitType type) {
+    switch (type) {
+        case INFANTRY: return "infantry";
+        case TANK: return "tank";
+        case BOAT: return "boat";
+        case HELICOPTER: return "helicopter";
+    }
+    return "unknown";
+}
+
+}
+
+const char* terrainImagePath(TerrainType type) {
+    switch (type) {
+        case GRASS: return "resources/gfx/grass.png";
+        case WATER: return "resources/gfx/water.png";
+        case ROAD: return "resources/gfx/road.png";
+        case MOUNTAIN: return "resources/gfx/mountain.png";
+    }
+    return nullptr;
+}
+
+const char* unitSheetPath(UnitType type, int player) {
+    switch (type) {
+        case INFANTRY: return player == 1 ? "resources/gfx/infantry_spritesheet_p1.png" : "resources/gfx/infantry_spritesheet_p2.png";
+        case TANK: return player == 1 ? "resources/gfx/tank_spritesheet_p1.png" : "resources/gfx/tank_spritesheet_p2.png";
+        case BOAT: return player == 1 ? "resources/gfx/boat_spritesheet_p1.png" : "resources/gfx/boat_spritesheet_p2.png";
+        case HELICOPTER: return player == 1 ? "resources/gfx/helicopter_spritesheet_p1.png" : "resources/gfx/helicopter_spritesheet_p2.png";
+    }
+    return nullptr;
+}
+
+const char* explosionSheetPath() {
+    return "resources/gfx/explosion_spritesheet.png";
+}
+
+SpriteSource spriteSource(int sprite, int tileSize) {
+    if (sprite < UNIT_SPRITES_BEGIN) {
+        return {terrainImagePath(static_cast<TerrainType>(sprite)), {0, 0, 0, 0}, {0, 0, tileSize, tileSize}};
+    }
+    if (sprite < EXPLOSION_SPRITES_BEGIN) {
+        // One frame per orientation, left to right, centred in the tile
+        int index = sprite - UNIT_SPRITES_BEGIN;
+        int sheet = index / UNIT_ORIENTATIONS, orientation = index % UNIT_ORIENTATIONS;
+        int inset = (tileSize - UNIT_FRAME_SIZE) / 2;
+        return {unitSheetPath(static_cast<UnitType>(sheet / 2), sheet % 2 == 0 ? 1 : 2),
+                {orientation * UNIT_FRAME_SIZE, 0, UNIT_FRAME_SIZE, UNIT_FRAME_SIZE},
+                {inset, inset, UNIT_FRAME_SIZE, UNIT_FRAME_SIZE}};
+    }
+    // Explosion frames fill the tile's width and keep their aspect ratio
+    int frame = sprite - EXPLOSION_SPRITES_BEGIN;
+    int height = tileSize * EXPLOSION_FRAME_HEIGHT / EXPLOSION_FRAME_WIDTH;
+    return {explosionSheetPath(), {frame * EXPLOSION_FRAME_WIDTH, 0, EXPLOSION_FRAME_WIDTH, EXPLOSION_FRAME_HEIGHT},
+            {0, (tileSize - height) / 2, tileSize, height}};
+}
+
+std::string spriteName(int sprite) {
+    if (sprite < UNIT_SPRITES_BEGIN) {
+        return std::string("terrain/") + terrainName(static_cast<TerrainType>(sprite));
+    }
+    if (sprite < EXPLOSION_SPRITES_BEGIN) {
+        int index = sprite - UNIT_SPRITES_BEGIN;
+        int sheet = index / UNIT_ORIENTATIONS;
+        return std::string("unit/") + unitName(static_cast<UnitType>(sheet / 2)) + (sheet % 2 == 0 ? "_p1/" : "_p2/") +
+               std::to_string(index % UNIT_ORIENTATIONS);
+    }
+    return "explosion/" + std::to_string(sprite - EXPLOSION_SPRITES_BEGIN);
+}
@@ -0,0 +1,337 @@
+#include "threat_map.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include "arena.hpp"
+#include "flood_fill.hpp"
+
+namespace {
+
+void extend(TileRect& rect, int left, int top, int right, int bottom) {
+    if (rect.empty()) {
+        rect = {left, top, right, bottom};
+        return;
+    }
+    rect.left = std::min(rect.left, left);
+    rect.top = std::min(rect.top, top);
+    rect.right = std::max(rect.right, right);
+    rect.bottom = std::max(rect.bottom, bottom);
+}
+
+TileRect clipped(TileRect rect, int width, int height) {
+    if (rect.empty()) return rect;
+    rect.left = std::max(rect.left, 0);
+    rect.top = std::max(rect.top, 0);
+    rect.right = std::min(rect.right, width - 1);
+    rect.bottom = std::min(rect.bottom, height - 1);
+    return rect;
+}
+
+}
+
+ThreatMap::ThreatMap() {
+    maxMove = MAX_MOVE_RANGE;
+    maxReach = 0;
+    for (const UnitTraits& traits : UNIT_TRAITS) {
+        maxReach = std::max(maxReach, traits.moveRange + traits.attackRange);
+    }
+    // Reach windows are one word per row
+    windowRows = std::min(2 * maxReach + 1, 64);
+}
+
+void ThreatMap::rebuild(const GameState& state) {
+    const Map& map = state.getMap();
+    const UnitPool& units = state.getUnits();
+    width = map.getWidth();
+    height = map.getHeight();
+    for (auto& byPlayer : layers) {
+        byPlayer.clear();
+    }
+    contributions.clear();
+    reachRows.clear();
+
+    // After a move: one reach window per unit
+    for (int i = 0; i < units.size(); i++) {
+        uint32_t slot = units.handleAt(i).slot;
+        computeReach(state, i, slot);
+        contributions[slot].shown = isShown(contributions[slot]);
+        if (contributions[slot].shown) addReach(slot, 1);
+    }
+
+    // Next turn: units grouped by player and attack range, in row order. For
+    // each row holding units of a group, their damage is spread along the
+    // row by shifted adds, and that row is added to the 2r + 1 rows it
+    // reaches. Both loops are plain adds of uint16_t rows.
+    std::vector<int> order;
+    for (int i = 0; i < units.size(); i++) {
+        if (contributions[units.handleAt(i).slot].shown) order.push_back(i);
+    }
+    std::sort(order.begin(), order.end(), [&](int a, int b) {
+        if (units.getPlayer(a) != units.getPlayer(b)) return units.getPlayer(a) < units.getPlayer(b);
+        if (units.getAttackRange(a) != units.getAttackRange(b)) return units.getAttackRange(a) < units.getAttackRange(b);
+        return units.getY(a) < units.getY(b);
+    });
+    ArenaScope scope(scratchArena());
+    uint16_t* source = scratchArena().allocateArray<uint16_t>(width);
+    uint16_t* spread = scratchArena().allocateArray<uint16_t>(width);
+    for (size_t begin = 0; begin < order.size();) {
+        int player = units.getPlayer(order[begin]);
+        int y = units.getY(order[begin]);
+        int range = units.getAttackRange(order[begin]);
+        size_t end = begin;
+        int left = width, right = -1;
+        while (end < order.size() && units.getPlayer(order[end]) == player && units.getY(order[end]) == y &&
+               units.getAttackRange(order[end]) == range) {
+            left = std::min(left, units.getX(order[end]));
+            right = std::max(right, units.getX(order[end]));
+            end++;
+        }
+
+        // Columns the row's units can reach
+        int spanLeft = std::max(0, left - range), spanRight = std::min(width - 1, right + range);
+        std::fill(source + spanLeft, source + spanRight + 1, 0);
+        std::fill(spread + spanLeft, spread + spanRight + 1, 0);
+        for (size_t i = begin; i < end; i++) {
+            source[units.getX(order[i])] += static_cast<uint16_t>(units.getAttackDamage(order[i]));
+        }
+        for (int dx = -range; dx <= range; dx++) {
+            int from = std::max(spanLeft, spanLeft - dx), to = std::min(spanRight, spanRight - dx);
+            for (int x = from; x <= to; x++) {
+                spread[x] += source[x + dx];
+            }
+        }
+        std::vector<uint16_t>& target = layer(THREAT_NEXT_TURN, player);
+        for (int row = std::max(0, y - range); row <= std::min(height - 1, y + range); row++) {
+            uint16_t* out = &target[static_cast<size_t>(row) * width];
+            for (int x = spanLeft; x <= spanRight; x++) {
+                out[x] += spread[x];
+            }
+        }
+        begin = end;
+    }
+    // A unit doesn't attack its own tile
+    for (int i : order) {
+        layer(THREAT_NEXT_TURN, units.getPlayer(i))[static_cast<size_t>(units.getY(i)) * width + units.getX(i)] -=
+            static_cast<uint16_t>(units.getAttackDamage(i));
+    }
+    stats.rebuilds++;
+}
+
+TileRect ThreatMap::setSight(const FogOfWar* newFog, int newViewer) {
+    fog = newFog;
+    viewer = newViewer;
+    TileRect changed;
+    for (uint32_t slot = 0; slot < contributions.size(); slot++) {
+        Contribution& unit = contributions[slot];
+        if (!unit.live || unit.shown == isShown(unit)) continue;
+        unit.shown = !unit.shown;
+        int sign = unit.shown ? 1 : -1;
+        addSquare(unit, sign);
+        addReach(slot, sign);
+        extend(changed, unit.originX, unit.originY, unit.originX + 2 * unit.reach, unit.originY + 2 * unit.reach);
+    }
+    return clipped(changed, width, height);
+}
+
+bool ThreatMap::isShown(const Contribution& unit) const {
+    return !fog || viewer == 0 || unit.player == viewer || fog->isVisible(viewer, unit.x, unit.y);
+}
+
+TileRect ThreatMap::unitMoved(const GameState& state, int index, Point from, Point to) {
+    TileRect changed;
+    uint32_t slot = state.getHandle(index).slot;
+    int player = state.getUnits().getPlayer(index);
+    unplace(slot, changed);
+    place(state, index, changed);
+    refreshEnemiesAround(state, player, from, changed);
+    refreshEnemiesAround(state, player, to, changed);
+    stats.updates++;
+    return clipped(changed, width, height);
+}
+
+TileRect ThreatMap::unitRemoved(const GameState& state, UnitHandle handle) {
+    TileRect changed;
+    if (handle.slot >= contributions.size() || !contributions[handle.slot].live) return changed;
+    const Contribution& unit = contributions[handle.slot];
+    int player = unit.player;
+    Point tile = {unit.x, unit.y};
+    unplace(handle.slot, changed);
+    refreshEnemiesAround(state, player, tile, changed);
+    stats.updates++;
+    return clipped(changed, width, height);
+}
+
+TileRect ThreatMap::unitAdded(const GameState& state, int index) {
+    TileRect changed;
+    const UnitPool& units = state.getUnits();
+    place(state, index, changed);
+    refreshEnemiesAround(state, units.getPlayer(index), {units.getX(index), units.getY(index)}, changed);
+    stats.updates++;
+    return clipped(changed, width, height);
+}
+
+int ThreatMap::getDamage(ThreatLayer threat, int player, int x, int y) const {
+    const uint16_t* values = row(threat, player, y);
+    return values ? values[x] : 0;
+}
+
+const uint16_t* ThreatMap::row(ThreatLayer threat, int player, int y) const {
+    const std::vector<std::vector<uint16_t>>& byPlayer = layers[threat];
+    if (player < 0 || player >= static_cast<int>(byPlayer.size()) || byPlayer[player].empty()) return nullptr;
+    return &byPlayer[player][static_cast<size_t>(y) * width];
+}
+
+std::vector<uint16_t>& ThreatMap::layer(ThreatLayer threat, int player) {
+    std::vector<std::vector<uint16_t>>& byPlayer = layers[threat];
+    if (player >= static_cast<int>(byPlayer.size())) byPlayer.resize(player + 1);
+    if (byPlayer[player].empty()) byPlayer[player].assign(static_cast<size_t>(width) * height, 0);
+    return byPlayer[player];
+}
+
+void ThreatMap::addSquare(const Contribution& unit, int sign) {
+    std::vector<uint16_t>& target = layer(THREAT_NEXT_TURN, unit.player);
+    int left = std::max(0, unit.x - unit.attackRange), right = std::min(width - 1, unit.x + unit.attackRange);
+    uint16_t delta = static_cast<uint16_t>(sign * unit.damage);
+    for (int y = std::max(0, unit.y - unit.attackRange); y <= std::min(height - 1, unit.y + unit.attackRange); y++) {
+        uint16_t* out = &target[static_cast<size_t>(y) * width];
+        for (int x = left; x <= right; x++) {
+            out[x] += delta;
+        }
+    }
+    target[static_cast<size_t>(unit.y) * width + unit.x] -= delta;
+}
+
+void ThreatMap::addReach(uint32_t slot, int sign) {
+    const Contribution& unit = contributions[slot];
+    std::vector<uint16_t>& target = layer(THREAT_AFTER_MOVE, unit.player);
+    const uint64_t* rows = &reachRows[static_cast<size_t>(slot) * windowRows];
+    uint16_t delta = static_cast<uint16_t>(sign * unit.damage);
+    int size = 2 * unit.reach + 1;
+    // Window columns that fall on the map
+    int firstColumn = std::max(0, -unit.originX), lastColumn = std::min(size - 1, width - 1 - unit.originX);
+    if (firstColumn > lastColumn) return;
+    uint64_t columns = (lastColumn == 63 ? ~uint64_t(0) : (uint64_t(1) << (lastColumn + 1)) - 1) & ~((uint64_t(1) << firstColumn) - 1);
+    for (int row = 0; row < size; row++) {
+        int y = unit.originY + row;
+        if (y < 0 || y >= height) continue;
+        uint16_t* out = &target[static_cast<size_t>(y) * width];
+        for (uint64_t bits = rows[row] & columns; bits; bits &= bits - 1) {
+            out[unit.originX + __builtin_ctzll(bits)] += delta;
+        }
+    }
+}
+
+void ThreatMap::computeReach(const GameState& state, int index, uint32_t slot) {
+    const UnitPool& units = state.getUnits();
+    const OccupancyGrid& occupancy = state.getOccupancy();
+    if (slot >= contributions.size()) {
+        contributions.resize(slot + 1);
+        reachRows.resize(contributions.size() * windowRows, 0);
+    }
+    Contribution& unit = contributions[slot];
+    int x = units.getX(index), y = units.getY(index);
+    int move = units.getMoveRange(index);
+    int attack = units.getAttackRange(index);
+    unit.live = true;
+    unit.player = units.getPlayer(index);
+    unit.x = x;
+    unit.y = y;
+    unit.attackRange = attack;
+    unit.damage = units.getAttackDamage(index);
+    unit.reach = move + attack;
+    unit.originX = x - unit.reach;
+    unit.originY = y - unit.reach;
+
+    uint64_t moves[64];
+    forUnitType(units.getType(index), [&](auto type) {
+        floodFillWindowOf<decltype(type)::value>(state.getMap().getPassability(units.getType(index)), occupancy.getOccupied(),
+                                                 occupancy.getPlayerTiles(unit.player), x, y, moves);
+    });
+
+    // Re-centre the movement window in the reach window, then grow every
+    // reached tile by the attack range: sideways with shifts, down the
+    // columns by ORing neighbouring rows
+    int size = 2 * unit.reach + 1;
+    uint64_t wide[64];
+    for (int row = 0; row < size; row++) {
+        int moveRow = row - attack;
+        uint64_t bits = moveRow >= 0 && moveRow <= 2 * move ? moves[moveRow] << attack : 0;
+        uint64_t grown = bits;
+        for (int step = 1; step <= attack; step++) {
+            grown |= (bits << step) | (bits >> step);
+        }
+        wide[row] = grown;
+    }
+    uint64_t* rows = &reachRows[static_cast<size_t>(slot) * windowRows];
+    for (int row = 0; row < size; row++) {
+        uint64_t bits = 0;
+        for (int other = std::max(0, row - attack); other <= std::min(size - 1, row + attack); other++) {
+            bits |= wide[other];
+        }
+        rows[row] = bits;
+    }
+    // Its own tiles are covered by the neighbouring ones it can reach, unless it can't move at all
+    int reached = 0;
+    for (int row = 0; row <= 2 * move; row++) {
+        reached += __builtin_popcountll(moves[row]);
+    }
+    if (reached == 1) rows[unit.reach] &= ~(uint64_t(1) << unit.reach);
+    stats.unitsRecomputed++;
+}
+
+void ThreatMap::refreshEnemiesAround(const GameState& state, int player, Point tile, TileRect& changed) {
+    const UnitPool& units = state.getUnits();
+    auto refresh = [&](int index) {
+        if (units.getPlayer(index) == player) return;
+        int distance = std::abs(units.getX(index) - tile.x) + std::abs(units.getY(index) - tile.y);
+        if (distance > units.getMoveRange(index)) return;
+        uint32_t slot = units.handleAt(index).slot;
+        if (slot >= contributions.size() || !contributions[slot].live) return;
+        Contribution& unit = contributions[slot];
+        extend(changed, unit.originX, unit.originY, unit.originX + 2 * unit.reach, unit.originY + 2 * unit.reach);
+        if (unit.shown) addReach(slot, -1);
+        computeReach(state, index, slot);
+        if (unit.shown) addReach(slot, 1);
+    };
+
+    // Enemies within maxMove steps: through the occupancy grid, unless
+    // there are fewer units than tiles in that square
+    int left = std::max(0, tile.x - maxMove), right = std::min(width - 1, tile.x + maxMove);
+    int top = std::max(0, tile.y - maxMove), bottom = std::min(height - 1, tile.y + maxMove);
+    if (static_cast<long>(right - left + 1) * (bottom - top + 1) > units.size()) {
+        for (int i = 0; i < units.size(); i++) {
+            refresh(i);
+        }
+        return;
+    }
+    const OccupancyGrid& occupancy = state.getOccupancy();
+    for (int y = top; y <= bottom; y++) {
+        for (int x = left; x <= right; x++) {
+            int occupant = occupancy.at(x, y);
+            if (occupant != OccupancyGrid::EMPTY) refresh(occupant);
+        }
+    }
+}
+
+void ThreatMap::place(const GameState& state, int index, TileRect& changed) {
+    const UnitPool& units = state.getUnits();
+    uint32_t slot = units.handleAt(index).slot;
+    computeReach(state, index, slot);
+    Contribution& unit = contributions[slot];
+    unit.shown = isShown(unit);
+    if (unit.shown) {
+        addSquare(unit, 1);
+        addReach(slot, 1);
+    }
+    extend(changed, unit.originX, unit.originY, unit.originX + 2 * unit.reach, unit.originY + 2 * unit.reach);
+}
+
+void ThreatMap::unplace(uint32_t slot, TileRect& changed) {
+    if (slot >= contributions.size() || !contributions[slot].live) return;
+    Contribution& unit = contributions[slot];
+    if (unit.shown) {
+        addSquare(unit, -1);
+        addReach(slot, -1);
+    }
+    extend(changed, unit.originX, unit.originY, unit.originX + 2 * unit.reach, unit.originY + 2 * unit.reach);
+    unit.live = false;
+}
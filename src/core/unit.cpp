@@ -0,0 +1,16 @@
+#include "unit.hpp"
+#include <cmath>
+
+Unit::Unit(UnitType type, int x, int y, int player, int orientation)
+    : type(type), x(x), y(y), player(player), orientation(orientation), health(UNIT_TRAITS[type].health) {
+}
+
+void Unit::setPosition(int newX, int newY) {
+    x = newX;
+    y = newY;
+}
+
+bool Unit::inAttackRange(int targetX, int targetY) const {
+    int attackRange = getAttackRange();
+    return (std::abs(targetX - x) <= attackRange && std::abs(targetY - y) <= attackRange);
+}
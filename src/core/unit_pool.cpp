@@ -0,0 +1,101 @@
+#include "unit_pool.hpp"
+#include <utility>
+
+UnitHandle UnitPool::spawn(const Unit& unit) {
+    uint32_t slot;
+    if (!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    } else {
+        slot = static_cast<uint32_t>(slotIndices.size());
+        slotIndices.push_back(-1);
+        slotGenerations.push_back(1);
+        // Every slot can end up free; removals then never allocate
+        freeSlots.reserve(slotIndices.capacity());
+    }
+
+    spawnInto(slot, unit);
+    return {slot, slotGenerations[slot]};
+}
+
+void UnitPool::spawnInto(uint32_t slot, const Unit& unit) {
+    slotIndices[slot] = size();
+    denseSlots.push_back(slot);
+    xs.push_back(unit.getX());
+    ys.push_back(unit.getY());
+    players.push_back(unit.getPlayer());
+    healths.push_back(unit.getHealth());
+    types.push_back(unit.getType());
+    orientations.push_back(unit.getOrientation());
+}
+
+void UnitPool::remove(int index) {
+    uint32_t slot = denseSlots[index];
+    slotIndices[slot] = -1;
+    slotGenerations[slot]++;
+    freeSlots.push_back(slot);
+
+    int last = size() - 1;
+    if (index != last) {
+        denseSlots[index] = denseSlots[last];
+        slotIndices[denseSlots[index]] = index;
+        xs[index] = xs[last];
+        ys[index] = ys[last];
+        players[index] = players[last];
+        healths[index] = healths[last];
+        types[index] = types[last];
+        orientations[index] = orientations[last];
+    }
+    denseSlots.pop_back();
+    xs.pop_back();
+    ys.pop_back();
+    players.pop_back();
+    healths.pop_back();
+    types.pop_back();
+    orientations.pop_back();
+}
+
+void UnitPool::restore(int index, const Unit& unit, UnitHandle handle) {
+    freeSlots.pop_back();
+    slotGenerations[handle.slot] = handle.generation;
+    spawnInto(handle.slot, unit);
+
+    int last = size() - 1;
+    if (index == last) return;
+    std::swap(denseSlots[index], denseSlots[last]);
+    slotIndices[denseSlots[index]] = index;
+    slotIndices[denseSlots[last]] = last;
+    std::swap(xs[index], xs[last]);
+    std::swap(ys[index], ys[last]);
+    std::swap(players[index], players[last]);
+    std::swap(healths[index], healths[last]);
+    std::swap(types[index], types[last]);
+    std::swap(orientations[index], orientations[last]);
+}
+
+void UnitPool::clear() {
+    // Free every slot rather than forgetting them, so old handles stay stale
+    while (!empty()) {
+        remove(size() - 1);
+    }
+}
+
+int UnitPool::indexOf(UnitHandle handle) const {
+    if (handle.slot >= slotIndices.size() || slotGenerations[handle.slot] != handle.generation) return -1;
+    return slotIndices[handle.slot];
+}
+
+Unit UnitPool::get(int index) const {
+    Unit unit(types[index], xs[index], ys[index], players[index], orientations[index]);
+    unit.takeDamage(unit.getHealth() - healths[index]);
+    return unit;
+}
+
+std::vector<Unit> UnitPool::toVector() const {
+    std::vector<Unit> units;
+    units.reserve(size());
+    for (int i = 0; i < size(); i++) {
+        units.push_back(get(i));
+    }
+    return units;
+}
@@ -0,0 +1,42 @@
+#include "draw.hpp"
+
+namespace {
+
+int drawCalls = 0;
+int textureSwitches = 0;
+SDL_Texture* lastTexture = nullptr;
+
+}
+
+int drawTexture(SDL_Renderer* renderer, SDL_Texture* texture, const SDL_Rect* srcRect, const SDL_Rect* dstRect) {
+    drawCalls++;
+    if (texture != lastTexture) {
+        textureSwitches++;
+        lastTexture = texture;
+    }
+    return SDL_RenderCopy(renderer, texture, srcRect, dstRect);
+}
+
+int drawFilledRect(SDL_Renderer* renderer, const SDL_Rect* rect) {
+    drawCalls++;
+    return SDL_RenderFillRect(renderer, rect);
+}
+
+int drawFilledRects(SDL_Renderer* renderer, const SDL_Rect* rects, int count) {
+    drawCalls++;
+    return SDL_RenderFillRects(renderer, rects, count);
+}
+
+int getDrawCallCount() {
+    return drawCalls;
+}
+
+int getTextureSwitchCount() {
+    return textureSwitches;
+}
+
+void resetDrawCallCount() {
+    drawCalls = 0;
+    textureSwitches = 0;
+    lastTexture = nullptr;
+}
@@ -0,0 +1,381 @@
+#include "game_renderer.hpp"
+#include <algorithm>
+#include <iostream>
+#include "draw.hpp"
+#include "profiler.hpp"
+
+namespace {
+
+// Damage at which the heatmap is fully saturated: a healthy infantry's worth
+const int HEAT_FULL_DAMAGE = 50;
+
+bool containsPoint(const std::vector<Point>& points, int x, int y) {
+    for (const Point& point : points) {
+        if (point.x == x && point.y == y) return true;
+    }
+    return false;
+}
+
+}
+
+GameRenderer::GameRenderer(SDL_Renderer* renderer, int tileSize, const GameState& state)
+    : renderer(renderer), tileSize(tileSize),
+      camera(0, 0, state.getMap().getWidth() * tileSize, state.getMap().getHeight() * tileSize),
+      mapRenderer(tileSize, sprites), unitRenderer(tileSize, sprites),
+      dirtyTiles(state.getMap().getWidth(), state.getMap().getHeight()) {
+    int width = 0, height = 0;
+    SDL_GetRendererOutputSize(renderer, &width, &height);
+    camera.setViewport(width, height);
+}
+
+bool GameRenderer::load(AssetCache& assets, const std::string& atlasFile) {
+    if (!atlasFile.empty()) {
+        if (sprites.loadPacked(atlasFile, tileSize, assets)) return true;
+        std::cerr << "No sprite atlas at " << atlasFile << ", drawing from the loose images (build the atlas target)" << std::endl;
+    }
+    if (!sprites.loadLoose(tileSize, assets)) {
+        std::cerr << "Failed to load sprites." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void GameRenderer::reset() {
+    mapRenderer.invalidate();
+    if (dirtyRendering) {
+        setDirtyRendering(true);
+    }
+    fullRedraw = true;
+}
+
+void GameRenderer::setDirtyRendering(bool enabled) {
+    dirtyRendering = enabled;
+    fullRedraw = true;
+    canvas.reset();
+    if (!enabled) return;
+
+    SDL_Texture* target = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET,
+                                            camera.getViewportWidth(), camera.getViewportHeight());
+    if (!target) {
+        std::cerr << "Dirty-region rendering unavailable, redrawing full frames: " << SDL_GetError() << std::endl;
+        dirtyRendering = false;
+        return;
+    }
+    SDL_SetTextureBlendMode(target, SDL_BLENDMODE_NONE);
+    canvas.reset(target, SDL_DestroyTexture);
+}
+
+void GameRenderer::setProfilerOverlay(bool visible) {
+    overlayVisible = visible;
+    // Show or hide it with the next frame even if nothing else changed
+    fullRedraw = true;
+}
+
+void GameRenderer::setFogOfWar(const FogOfWar* newFog, int newViewer) {
+    if (newFog == fog && newViewer == viewer) return;
+    fog = newFog;
+    viewer = newViewer;
+    fullRedraw = true;
+}
+
+void GameRenderer::setThreatOverlay(const ThreatMap* newThreats, ThreatLayer layer) {
+    if (newThreats == threats && layer == threatLayer) return;
+    threats = newThreats;
+    threatLayer = layer;
+    fullRedraw = true;
+}
+
+void GameRenderer::markTilesDirty(const TileRect& rect) {
+    for (int y = rect.top; y <= rect.bottom; y++) {
+        for (int x = rect.left; x <= rect.right; x++) {
+            markTileDirty(x, y);
+        }
+    }
+}
+
+void GameRenderer::markTileDirty(int x, int y) {
+    if (x < 0 || y < 0 || x >= dirtyTiles.getWidth() || y >= dirtyTiles.getHeight()) return;
+    if (!dirtyTiles.test(x, y)) {
+        dirtyTiles.set(x, y);
+        dirtyList.push_back({x, y});
+    }
+}
+
+void GameRenderer::markHighlightsDirty(const GameState& state) {
+    for (const Point& point : drawnHighlights) {
+        markTileDirty(point.x, point.y);
+    }
+    updateShownMovement(state);
+    for (const Point& point : shownMovement) {
+        markTileDirty(point.x, point.y);
+    }
+    for (const Point& point : state.getAttackRange()) {
+        markTileDirty(point.x, point.y);
+    }
+}
+
+bool GameRenderer::renderFrame(const GameState& state, const AnimationScheduler& animations) {
+    frameArena.reset();
+    // Where animations were last frame and where they are now both need repainting
+    animationTiles.clear();
+    animations.coveredTiles(tileSize, animationTiles);
+    for (const Point& tile : drawnAnimationTiles) {
+        markTileDirty(tile.x, tile.y);
+    }
+    for (const Point& tile : animationTiles) {
+        markTileDirty(tile.x, tile.y);
+    }
+    // The heatmap follows the side to move when no viewer is fixed
+    if (threats && shownSide(state) != drawnThreatSide) {
+        drawnThreatSide = shownSide(state);
+        fullRedraw = true;
+    }
+    if (!needsRedraw()) return false;
+    // Anything cached in screen space is stale once the camera moved
+    if (camera.getRevision() != drawnCameraRevision) fullRedraw = true;
+
+    resetDrawCallCount();
+    if (dirtyRendering && canvas) {
+        SDL_SetRenderTarget(renderer, canvas.get());
+        if (fullRedraw) {
+            drawScene(state, animations);
+        } else {
+            BATTLE_PROFILE_SCOPE("dirty_tiles");
+            for (const Point& tile : dirtyList) {
+                if (camera.isVisible(tileRect(tile.x, tile.y))) {
+                    drawTile(state, animations, tile.x, tile.y);
+                }
+            }
+            SDL_RenderSetClipRect(renderer, nullptr);
+        }
+        SDL_SetRenderTarget(renderer, nullptr);
+        drawTexture(renderer, canvas.get(), nullptr, nullptr);
+    } else {
+        drawScene(state, animations);
+    }
+    if (overlayVisible) {
+        BATTLE_PROFILE_SCOPE("overlay");
+        overlay.draw(renderer, frameArena, 8, 8);
+    }
+    {
+        BATTLE_PROFILE_SCOPE("present");
+        SDL_RenderPresent(renderer);
+    }
+
+    lastDrawCalls = getDrawCallCount();
+    lastTextureSwitches = getTextureSwitchCount();
+    rememberHighlights(state);
+    drawnAnimationTiles.swap(animationTiles);
+    for (const Point& tile : dirtyList) {
+        dirtyTiles.reset(tile.x, tile.y);
+    }
+    dirtyList.clear();
+    fullRedraw = false;
+    drawnCameraRevision = camera.getRevision();
+    return true;
+}
+
+void GameRenderer::drawScene(const GameState& state, const AnimationScheduler& animations) {
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+    SDL_RenderClear(renderer);
+
+    const Map& map = state.getMap();
+    {
+        BATTLE_PROFILE_SCOPE("terrain");
+        mapRenderer.render(renderer, map, camera, frameArena);
+    }
+
+    // Units standing on visible tiles, looked up through the occupancy grid
+    const UnitPool& units = state.getUnits();
+    int left, top, right, bottom, pixelX, pixelY;
+    camera.visibleTiles(tileSize, map.getWidth(), map.getHeight(), left, top, right, bottom);
+    if (fog && viewer != 0) {
+        BATTLE_PROFILE_SCOPE("fog");
+        drawFog(left, top, right, bottom);
+    }
+    {
+        BATTLE_PROFILE_SCOPE("units");
+        for (int y = top; y <= bottom; y++) {
+            for (int x = left; x <= right; x++) {
+                int occupant = state.unitAt(x, y);
+                if (occupant != -1 && showsUnit(units.getPlayer(occupant), x, y) &&
+                    !animations.unitPosition(units.handleAt(occupant), tileSize, pixelX, pixelY)) {
+                    unitRenderer.render(renderer, camera, units.get(occupant), x, y);
+                }
+            }
+        }
+        for (const UnitMoveAnimation& move : animations.getMoves()) {
+            int index = units.indexOf(move.unit);
+            if (index == -1) continue;
+            animations.unitPosition(move.unit, tileSize, pixelX, pixelY);
+            // A walking enemy shows while the tile under its centre is in sight
+            if (!showsUnit(units.getPlayer(index), (pixelX + tileSize / 2) / tileSize, (pixelY + tileSize / 2) / tileSize)) continue;
+            if (camera.isVisible({ pixelX, pixelY, tileSize, tileSize })) {
+                unitRenderer.renderAt(renderer, camera, units.get(index), pixelX, pixelY);
+            }
+        }
+    }
+
+    for (const ExplosionAnimation& explosion : animations.getExplosions()) {
+        if (camera.isVisible(tileRect(explosion.tile.x, explosion.tile.y))) {
+            drawExplosion(animations, explosion);
+        }
+    }
+
+    if (threats) {
+        BATTLE_PROFILE_SCOPE("threats");
+        drawThreats(state, left, top, right, bottom);
+    }
+
+    // Display movement and attack ranges
+    if (state.getSelectedIndex() != -1) {
+        BATTLE_PROFILE_SCOPE("highlights");
+        for (const Point& point : shownMovement) {
+            if (camera.isVisible(tileRect(point.x, point.y))) drawHighlight(state, point, false);
+        }
+        for (const Point& point : state.getAttackRange()) {
+            if (camera.isVisible(tileRect(point.x, point.y))) drawHighlight(state, point, true);
+        }
+    }
+}
+
+void GameRenderer::drawTile(const GameState& state, const AnimationScheduler& animations, int x, int y) {
+    // Terrain first: it may bake a chunk, which switches render targets and drops the clip rect
+    mapRenderer.renderTile(renderer, state.getMap(), camera, x, y);
+
+    // Walking sprites straddle tiles, so keep everything inside this one
+    SDL_Rect clip = camera.toScreen(tileRect(x, y));
+    SDL_RenderSetClipRect(renderer, &clip);
+
+    // Same layering as drawScene, restricted to what covers this tile
+    if (fog && viewer != 0) {
+        drawFog(x, y, x, y);
+    }
+    const UnitPool& units = state.getUnits();
+    int pixelX = 0, pixelY = 0;
+    int occupant = state.unitAt(x, y);
+    if (occupant != -1 && showsUnit(units.getPlayer(occupant), x, y) &&
+        !animations.unitPosition(units.handleAt(occupant), tileSize, pixelX, pixelY)) {
+        unitRenderer.render(renderer, camera, units.get(occupant), x, y);
+    }
+    for (const UnitMoveAnimation& move : animations.getMoves()) {
+        int index = units.indexOf(move.unit);
+        if (index == -1) continue;
+        animations.unitPosition(move.unit, tileSize, pixelX, pixelY);
+        if (!showsUnit(units.getPlayer(index), (pixelX + tileSize / 2) / tileSize, (pixelY + tileSize / 2) / tileSize)) continue;
+        if (pixelX < (x + 1) * tileSize && pixelX + tileSize > x * tileSize && pixelY < (y + 1) * tileSize && pixelY + tileSize > y * tileSize) {
+            unitRenderer.renderAt(renderer, camera, units.get(index), pixelX, pixelY);
+        }
+    }
+
+    for (const ExplosionAnimation& explosion : animations.getExplosions()) {
+        if (explosion.tile.x == x && explosion.tile.y == y) {
+            drawExplosion(animations, explosion);
+        }
+    }
+    if (threats) {
+        drawThreats(state, x, y, x, y);
+    }
+
+    if (state.getSelectedIndex() != -1) {
+        if (containsPoint(shownMovement, x, y)) {
+            drawHighlight(state, {x, y}, false);
+        }
+        if (containsPoint(state.getAttackRange(), x, y)) {
+            drawHighlight(state, {x, y}, true);
+        }
+    }
+}
+
+void GameRenderer::drawExplosion(const AnimationScheduler& animations, const ExplosionAnimation& explosion) {
+    sprites.draw(renderer, camera, explosionSprite(animations.explosionFrame(explosion)),
+                 explosion.tile.x * tileSize, explosion.tile.y * tileSize);
+}
+
+void GameRenderer::drawFog(int left, int top, int right, int bottom) {
+    // One rectangle per run of unseen tiles in a row, found a word at a time
+    const BitGrid& seen = fog->getVisible(viewer);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 140);
+    for (int y = top; y <= bottom; y++) {
+        const uint64_t* words = seen.row(y);
+        int x = left;
+        while (x <= right) {
+            // Skip to the next unseen tile, then to the end of its run
+            uint64_t hidden = ~words[x >> 6] >> (x & 63);
+            if (!hidden) {
+                x = (x | 63) + 1;
+                continue;
+            }
+            x += __builtin_ctzll(hidden);
+            if (x > right) break;
+            int end = x;
+            while (end <= right) {
+                uint64_t lit = words[end >> 6] >> (end & 63);
+                if (lit) {
+                    end += __builtin_ctzll(lit);
+                    break;
+                }
+                end = (end | 63) + 1;
+            }
+            end = std::min(end, right + 1);
+            SDL_Rect rect = camera.toScreen({ x * tileSize, y * tileSize, (end - x) * tileSize, tileSize });
+            drawFilledRect(renderer, &rect);
+            x = end;
+        }
+    }
+}
+
+void GameRenderer::drawThreats(const GameState& state, int left, int top, int right, int bottom) {
+    // Threats against the side being shown, one rectangle per run of equal
+    // damage; under fog the map only counts enemies the viewer sees
+    int enemy = shownSide(state) == 1 ? 2 : 1;
+    for (int y = top; y <= bottom; y++) {
+        const uint16_t* damage = threats->row(threatLayer, enemy, y);
+        if (!damage) return;
+        int x = left;
+        while (x <= right) {
+            int end = x + 1;
+            while (end <= right && damage[end] == damage[x]) end++;
+            if (damage[x] > 0) {
+                int heat = std::min<int>(damage[x], HEAT_FULL_DAMAGE);
+                SDL_SetRenderDrawColor(renderer, 255, static_cast<Uint8>(160 - heat * 160 / HEAT_FULL_DAMAGE), 0,
+                                       static_cast<Uint8>(48 + heat * 112 / HEAT_FULL_DAMAGE));
+                SDL_Rect rect = camera.toScreen({ x * tileSize, y * tileSize, (end - x) * tileSize, tileSize });
+                drawFilledRect(renderer, &rect);
+            }
+            x = end;
+        }
+    }
+}
+
+void GameRenderer::drawHighlight(const GameState& state, const Point& point, bool attack) {
+    SDL_Rect rect = camera.toScreen(tileRect(point.x, point.y));
+    if (!attack) {
+        // Green tiles for movement range
+        SDL_SetRenderDrawColor(renderer, 0, 255, 0, 96);
+        drawFilledRect(renderer, &rect);
+        return;
+    }
+    // Yellow tiles for attackable enemies, as far as they can be seen
+    int occupant = state.unitAt(point.x, point.y);
+    if (occupant != -1 && state.getUnits().getPlayer(occupant) != state.getCurrentPlayer() &&
+        showsUnit(state.getUnits().getPlayer(occupant), point.x, point.y)) {
+        SDL_SetRenderDrawColor(renderer, 255, 255, 0, 96);
+        drawFilledRect(renderer, &rect);
+    }
+}
+
+void GameRenderer::updateShownMovement(const GameState& state) {
+    int index = state.getSelectedIndex();
+    const UnitPool& units = state.getUnits();
+    if (index == -1 || !fog || viewer == 0 || units.getPlayer(index) != viewer) {
+        shownMovement = state.getMovementRange();
+        return;
+    }
+    fog->knownMovementRange(state, viewer, index, knownOccupied, shownMovement);
+}
+
+void GameRenderer::rememberHighlights(const GameState& state) {
+    drawnHighlights = shownMovement;
+    drawnHighlights.insert(drawnHighlights.end(), state.getAttackRange().begin(), state.getAttackRange().end());
+}
@@ -1,32 +1,83 @@
 #include <SDL.h>
 #include <SDL_image.h>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <future>
 #include <iostream>
-#include <fstream>
+#include <memory>
 #include <vector>
-#include <queue>
-#include "map.hpp"
-#include "unit.hpp"
-
-struct Explosion {
-    SDL_Point position;
-    int currentFrame = 0;
-    bool active = false;
-};
+#include "ai_player.hpp"
+#include "allocation_counter.hpp"
+#include "animation_scheduler.hpp"
+#include "asset_cache.hpp"
+#include "battle_setup.hpp"
+#include "command_log.hpp"
+#include "fog_of_war.hpp"
+#include "game_renderer.hpp"
+#include "game_state.hpp"
+#include "profiler.hpp"
+#include "threat_map.hpp"
 
 const int SCREEN_WIDTH = 640;
 const int SCREEN_HEIGHT = 640;
 const int TILE_SIZE = 64;
-const int EXPLOSION_FRAME_WIDTH = 3600; 
-const int EXPLOSION_FRAME_HEIGHT = 140;
-const int EXPLOSION_TOTAL_FRAMES = 15;  
-
-std::vector<Explosion> explosions;
+const int MAX_MAP_SIZE = 8192;
+const double PAN_STEP = 64.0;     // screen pixels per arrow key press
+const double ZOOM_STEP = 1.25;
+const int AI_POLL_MS = 10;        // how often the loop checks on a running AI search
+
+struct Options {
+    bool dirtyRects = false;  // --dirty-rects: repaint only changed tiles
+    BattleSetup battle;       // --map FILE, or --random-map WIDTH HEIGHT [--seed N] for generated terrain
+    bool profile = false;     // --profile: start with the profiler overlay shown
+    std::string traceFile;    // --trace FILE: record from the start, write a Chrome trace on exit
+    std::string recordFile;   // --record FILE: write the match's command log on exit
+    bool aiPlayers[3] = {false, false, false};  // --ai PLAYER: the computer plays that side (repeatable)
+    int aiTimeMs = 500;       // --ai-time MS: search budget per AI move
+    bool fogOfWar = true;     // --no-fog: both players see the whole board
+    std::string atlasFile = "atlas/sprites.atlas";  // --atlas FILE: packed sprites, see tools/atlas_packer.cpp
+};
 
-bool loadUnits(const std::string& filename, int player, SDL_Renderer* renderer, std::vector<Unit>& units);
-std::vector<SDL_Point> calculateMovementRange(const Unit& unit, const Map& map, const std::vector<Unit>& units);
-std::vector<SDL_Point> calculateAttackRange(const Unit& unit, const Map& map);
+int runGame(SDL_Renderer* renderer, const Options& options);
 
 int main(int argc, char* argv[]) {
+    Options options;
+    options.battle.maxMapSize = MAX_MAP_SIZE;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--dirty-rects") == 0) {
+            options.dirtyRects = true;
+        } else if (std::strcmp(argv[i], "--map") == 0 && i + 1 < argc) {
+            options.battle.mapFile = argv[++i];
+        } else if (std::strcmp(argv[i], "--random-map") == 0 && i + 2 < argc) {
+            options.battle.randomWidth = std::atoi(argv[++i]);
+            options.battle.randomHeight = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            options.battle.terrainSeed = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--profile") == 0) {
+            options.profile = true;
+        } else if (std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            options.traceFile = argv[++i];
+        } else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            options.recordFile = argv[++i];
+        } else if (std::strcmp(argv[i], "--ai") == 0 && i + 1 < argc) {
+            int player = std::atoi(argv[++i]);
+            if (player == 1 || player == 2) {
+                options.aiPlayers[player] = true;
+            } else {
+                std::cerr << "--ai expects 1 or 2" << std::endl;
+            }
+        } else if (std::strcmp(argv[i], "--ai-time") == 0 && i + 1 < argc) {
+            options.aiTimeMs = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--no-fog") == 0) {
+            options.fogOfWar = false;
+        } else if (std::strcmp(argv[i], "--atlas") == 0 && i + 1 < argc) {
+            options.atlasFile = argv[++i];
+        } else {
+            std::cerr << "Unknown option: " << argv[i] << std::endl;
+        }
+    }
+
     if (SDL_Init(SDL_INIT_VIDEO) != 0) {
         std::cerr << "SDL_Init Error: " << SDL_GetError() << std::endl;
         return 1;
@@ -39,7 +90,7 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
-    SDL_Renderer* renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+    SDL_Renderer* renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_TARGETTEXTURE);
     if (!renderer) {
         std::cerr << "SDL_CreateRenderer Error: " << SDL_GetError() << std::endl;
         SDL_DestroyWindow(window);
@@ -57,292 +108,303 @@ int main(int argc, char* argv[]) {
     
     SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
 
-    Map gameMap(SCREEN_WIDTH / TILE_SIZE, SCREEN_HEIGHT / TILE_SIZE, TILE_SIZE);
-    if (!gameMap.loadMap("resources/layouts/map.txt", renderer)) {
-        std::cerr << "Failed to load map." << std::endl;
-    }
+    int result = runGame(renderer, options);
 
-    std::vector<Unit> units;
-    if (!loadUnits("resources/layouts/player1.txt", 1, renderer, units)) {
-        std::cerr << "Failed to load units for player 1." << std::endl;
-    }
-    if (!loadUnits("resources/layouts/player2.txt", 2, renderer, units)) {
-        std::cerr << "Failed to load units for player 2." << std::endl;
+    IMG_Quit();
+    SDL_DestroyRenderer(renderer);
+    SDL_DestroyWindow(window);
+    SDL_Quit();
+    return result;
+}
+
+int runGame(SDL_Renderer* renderer, const Options& options) {
+    auto startupBegin = std::chrono::steady_clock::now();
+
+    GameState state(0, 0);
+    if (!loadBattle(options.battle, state)) {
+        return 1;
     }
 
-    SDL_Texture* explosionTexture = IMG_LoadTexture(renderer, "resources/gfx/explosion_spritesheet.png");
-    if (!explosionTexture) {
-        std::cerr << "Failed to load explosion spritesheet: " << IMG_GetError() << std::endl;
+    // Decode every image we need up front on worker threads; the renderers
+    // below then only hit the cache
+    AssetCache assets(renderer);
+    assets.preload(SpriteAtlas::imagePaths(options.atlasFile, TILE_SIZE));
+
+    GameRenderer gameRenderer(renderer, TILE_SIZE, state);
+    if (!gameRenderer.load(assets, options.atlasFile)) {
         return 1;
     }
+    gameRenderer.setDirtyRendering(options.dirtyRects);
+    gameRenderer.setProfilerOverlay(options.profile);
+    Profiler& profiler = Profiler::instance();
+    profiler.setEnabled(options.profile || !options.traceFile.empty());
+
+    assets.printStats(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startupBegin).count());
+
+    // Every accepted command, for replaying the match headless later
+    CommandLog commandLog;
+    commandLog.begin(state);
+
+    // The board is drawn as one player sees it: the human side against the
+    // AI, the player to move in a hot-seat game, everything when the AI
+    // plays itself
+    FogOfWar fog;
+    fog.rebuild(state);
+    auto fogViewer = [&]() {
+        if (!options.fogOfWar || (options.aiPlayers[1] && options.aiPlayers[2])) return 0;
+        if (options.aiPlayers[1]) return 2;
+        if (options.aiPlayers[2]) return 1;
+        return state.getCurrentPlayer();
+    };
+    gameRenderer.setFogOfWar(&fog, fogViewer());
+
+    // Built the first time the heatmap is shown, then kept up to date, with
+    // the same view of the board as the fog
+    ThreatMap threats;
+    bool threatsBuilt = false;
+    int threatMode = 0;  // F5 cycles: off, next turn, after a move
 
     bool running = true;
     SDL_Event event;
-    Unit* selectedUnit = nullptr;
-    Unit* targetEnemy = nullptr;
-    std::vector<SDL_Point> movementRange;
-    std::vector<SDL_Point> attackRange;
-    SDL_Point destination = {-1, -1};
-    bool animating = false;
-    int currentPlayer = 1;  // Track player turns (1 or 2)
-
-    while (running) {
-        while (SDL_PollEvent(&event)) {
-            if (event.type == SDL_QUIT) {
-                running = false;
-            } else if (event.type == SDL_MOUSEBUTTONDOWN && event.button.button == SDL_BUTTON_LEFT) {
-                int mouseX = event.button.x / TILE_SIZE;
-                int mouseY = event.button.y / TILE_SIZE;
-
-                if (!animating) {
-                    bool validTileClicked = false;
-                    targetEnemy = nullptr;
-
-                    // Selecting a new unit of the current player
-                    for (Unit& unit : units) {
-                        if (unit.getX() == mouseX && unit.getY() == mouseY && unit.getPlayer() == currentPlayer && unit.isAlive()) {
-                            selectedUnit = &unit;
-                            movementRange = calculateMovementRange(unit, gameMap, units);
-                            attackRange = calculateAttackRange(unit, gameMap);
-                            validTileClicked = true;
-                            break;
-                        }
-                    }
-
-                    if (selectedUnit) {
-                        // Check for movement (green tiles) within range
-                        for (const SDL_Point& point : movementRange) {
-                            if (point.x == mouseX && point.y == mouseY) {
-                                destination = point;
-                                animating = true;
-                                validTileClicked = true;
-                                break;
-                            }
-                        }
-
-                        // Check for attack (yellow tiles) on an enemy
-                        for (const SDL_Point& point : attackRange) {
-                            if (point.x == mouseX && point.y == mouseY) {
-                                for (Unit& enemyUnit : units) {
-                                    if (enemyUnit.getX() == mouseX && enemyUnit.getY() == mouseY && enemyUnit.getPlayer() != currentPlayer && enemyUnit.isAlive()) {
-                                        destination = {selectedUnit->getX(), selectedUnit->getY()};  // Stay in place after attacking
-                                        animating = true;
-                                        targetEnemy = &enemyUnit;
-                                        validTileClicked = true;
-                                        break;
-                                    }
-                                }
-                            }
-                            if (targetEnemy) break;
-                        }
+    AnimationScheduler animations;
+    long framesDrawn = 0;
+    long drawCallsTotal = 0;
+    long textureSwitchesTotal = 0;
+    // After the first frame, which loads and sizes everything
+    long framesAllocating = 0;
+    uint64_t frameAllocationsTotal = 0;
+    Camera& camera = gameRenderer.getCamera();
+
+    // The AI searches on a snapshot of the state in the background, so the
+    // window stays responsive while it thinks
+    std::unique_ptr<AiPlayer> ai;
+    if (options.aiPlayers[1] || options.aiPlayers[2]) {
+        AiSettings settings;
+        settings.timeBudgetMs = options.aiTimeMs;
+        ai = std::make_unique<AiPlayer>(settings);
+    }
+    std::future<bool> aiSearch;
+    AiAction aiAction;
+    bool aiStuck = false;  // the rules have no "pass", so an AI without a move ends play
+
+    // The state is updated immediately, animations only catch up visually,
+    // so input is never blocked while something is playing
+    std::vector<Point> path;  // reused by every move
+    auto applyCommand = [&](const Command& command) {
+        int player = state.getCurrentPlayer();
+        // The target's handle is gone once the attack kills it
+        UnitHandle target;
+        if (command.type == ATTACK && state.unitAt(command.x, command.y) != -1) {
+            target = state.getHandle(state.unitAt(command.x, command.y));
+        }
+        StepResult result = state.step(command);
+        commandLog.record(command, result, state);
+        switch (result.outcome) {
+            case SELECTED:
+                break;
+            case MOVED: {
+                // Walk the route the rules allowed, around water and enemies
+                if (!state.findPath(result.unitIndex, result.from, result.to, path)) {
+                    path = {result.from, result.to};
+                }
+                animations.startMove(state.getHandle(result.unitIndex), path);
+                gameRenderer.markTileDirty(result.to.x, result.to.y);
+                gameRenderer.markTilesDirty(fog.unitMoved(state, result.unitIndex, result.from, result.to));
+                if (threatsBuilt) {
+                    gameRenderer.markTilesDirty(threats.unitMoved(state, result.unitIndex, result.from, result.to));
+                }
+                break;
+            }
+            case ATTACKED: {
+                std::cout << "Enemy took " << result.damage << " damage!" << std::endl;
+                if (result.killed) {
+                    std::cout << "Enemy defeated!" << std::endl;
+                    gameRenderer.markTilesDirty(fog.unitRemoved(state, player == 1 ? 2 : 1, result.to));
+                    if (threatsBuilt) {
+                        gameRenderer.markTilesDirty(threats.unitRemoved(state, target));
                     }
 
-                    if (!validTileClicked) {
-                        std::cout << "Invalid action: Clicked outside of movement or attack range." << std::endl;
-                    }
+                    // Trigger explosion animation at the defeated unit's location;
+                    // its walk, if any, ends by itself now that the unit is gone
+                    animations.startExplosion(result.to);
+                } else {
+                    std::cout << "Enemy health: " << state.getUnits().getHealth(result.targetIndex) << std::endl;
                 }
+                break;
             }
+            case INVALID_COMMAND:
+                std::cout << "Invalid action: Clicked outside of movement or attack range." << std::endl;
+                break;
         }
-
-        // Render game
-        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-        SDL_RenderClear(renderer);
-
-        gameMap.render(renderer);
-        for (Unit& unit : units) {
-            if (unit.isAlive()) {
-                unit.render(renderer, TILE_SIZE);
-            }
-        }   
-
-        // Render explosion animation
-        for (Explosion& explosion : explosions) {
-            if (explosion.active) {
-                // explosions are in one single row, so we can calculate the frame position based on the current frame
-                SDL_Rect srcRect = { (explosion.currentFrame % EXPLOSION_TOTAL_FRAMES) * EXPLOSION_FRAME_WIDTH, 0, EXPLOSION_FRAME_WIDTH, EXPLOSION_FRAME_HEIGHT };
-                SDL_Rect dstRect = { explosion.position.x, explosion.position.y, TILE_SIZE, TILE_SIZE };
-                SDL_RenderCopy(renderer, explosionTexture, &srcRect, &dstRect);
-                explosion.currentFrame++;
-                SDL_Delay(500);  // Explosion animation delay
-
-                if (explosion.currentFrame >= EXPLOSION_TOTAL_FRAMES) {
-                    explosion.active = false;
-                }
+        if (result.outcome != INVALID_COMMAND) {
+            gameRenderer.setFogOfWar(&fog, fogViewer());
+            gameRenderer.markHighlightsDirty(state);
+            if (threatsBuilt) {
+                gameRenderer.markTilesDirty(threats.setSight(&fog, fogViewer()));
             }
         }
+    };
+
+    auto handleEvent = [&](const SDL_Event& event) {
+        if (event.type == SDL_QUIT) {
+            running = false;
+        } else if (event.type == SDL_WINDOWEVENT) {
+            gameRenderer.markAllDirty();
+        } else if (event.type == SDL_RENDER_TARGETS_RESET) {
+            gameRenderer.reset();
+        } else if (event.type == SDL_KEYDOWN) {
+            switch (event.key.keysym.sym) {
+                case SDLK_LEFT: case SDLK_a: camera.pan(-PAN_STEP, 0); break;
+                case SDLK_RIGHT: case SDLK_d: camera.pan(PAN_STEP, 0); break;
+                case SDLK_UP: case SDLK_w: camera.pan(0, -PAN_STEP); break;
+                case SDLK_DOWN: case SDLK_s: camera.pan(0, PAN_STEP); break;
+                case SDLK_EQUALS: camera.zoomAt(ZOOM_STEP, camera.getViewportWidth() / 2, camera.getViewportHeight() / 2); break;
+                case SDLK_MINUS: camera.zoomAt(1.0 / ZOOM_STEP, camera.getViewportWidth() / 2, camera.getViewportHeight() / 2); break;
+                case SDLK_F3:
+                    // Only record while someone is looking or a trace was asked for
+                    gameRenderer.setProfilerOverlay(!gameRenderer.isProfilerOverlayVisible());
+                    profiler.setEnabled(gameRenderer.isProfilerOverlayVisible() || !options.traceFile.empty());
+                    break;
+                case SDLK_F4:
+                    profiler.exportChromeTrace(options.traceFile.empty() ? "profile_trace.json" : options.traceFile);
+                    break;
+                case SDLK_F5:
+                    threatMode = (threatMode + 1) % (THREAT_LAYER_COUNT + 1);
+                    if (threatMode == 0) {
+                        gameRenderer.setThreatOverlay(nullptr, THREAT_NEXT_TURN);
+                        std::cout << "Threat overlay off" << std::endl;
+                        break;
+                    }
+                    if (!threatsBuilt) {
+                        // Enemies count only while the viewer sees them
+                        threats.setSight(&fog, fogViewer());
+                        threats.rebuild(state);
+                        threatsBuilt = true;
+                    }
+                    gameRenderer.setThreatOverlay(&threats, static_cast<ThreatLayer>(threatMode - 1));
+                    std::cout << (threatMode == 1 ? "Threat overlay: enemy attacks next turn" : "Threat overlay: enemy attacks after a move")
+                              << std::endl;
+                    break;
+            }
+        } else if (event.type == SDL_MOUSEWHEEL) {
+            int mouseX = 0, mouseY = 0;
+            SDL_GetMouseState(&mouseX, &mouseY);
+            camera.zoomAt(event.wheel.y > 0 ? ZOOM_STEP : 1.0 / ZOOM_STEP, mouseX, mouseY);
+        } else if (event.type == SDL_MOUSEMOTION && (event.motion.state & (SDL_BUTTON_RMASK | SDL_BUTTON_MMASK))) {
+            // Drag with the right or middle button to scroll
+            camera.pan(-event.motion.xrel, -event.motion.yrel);
+        } else if (event.type == SDL_MOUSEBUTTONDOWN && event.button.button == SDL_BUTTON_LEFT) {
+            int mouseX = 0, mouseY = 0;
+            if (!camera.screenToTile(event.button.x, event.button.y, TILE_SIZE, mouseX, mouseY)) {
+                return;
+            }
 
-        // Display movement and attack ranges
-        if (selectedUnit) {
-            // Green tiles for movement range
-            for (const SDL_Point& point : movementRange) {
-                SDL_SetRenderDrawColor(renderer, 0, 255, 0, 96);
-                SDL_Rect rangeRect = { point.x * TILE_SIZE, point.y * TILE_SIZE, TILE_SIZE, TILE_SIZE };
-                SDL_RenderFillRect(renderer, &rangeRect);
+            // The computer's units are not the player's to command
+            if (options.aiPlayers[state.getCurrentPlayer()]) {
+                return;
             }
-            // Yellow tiles for attackable enemies
-            for (const SDL_Point& point : attackRange) {
-                for (Unit& enemyUnit : units) {
-                    if (enemyUnit.getX() == point.x && enemyUnit.getY() == point.y && enemyUnit.getPlayer() != currentPlayer && enemyUnit.isAlive()) {
-                        SDL_SetRenderDrawColor(renderer, 255, 255, 0, 96);
-                        SDL_Rect attackRect = { point.x * TILE_SIZE, point.y * TILE_SIZE, TILE_SIZE, TILE_SIZE };
-                        SDL_RenderFillRect(renderer, &attackRect);
-                    }
-                }
+            // An enemy out of sight can't be targeted: the click counts as
+            // one on an empty tile, so it gives nothing away either
+            Command command = state.commandForClick(mouseX, mouseY);
+            if (command.type == ATTACK && fogViewer() != 0 && !fog.isVisible(state.getCurrentPlayer(), mouseX, mouseY)) {
+                command.type = MOVE;
             }
+            applyCommand(command);
         }
+    };
 
-        SDL_RenderPresent(renderer);
-
-        // Movement and attack logic with animation
-        if (animating && selectedUnit) {
-            animating = selectedUnit->animateMovement(destination.x, destination.y, TILE_SIZE);
-            
-            if (!animating) {
-                if (targetEnemy && selectedUnit->inAttackRange(targetEnemy->getX(), targetEnemy->getY())) {
-                    targetEnemy->takeDamage(selectedUnit->getAttackDamage());
-                    std::cout << "Enemy took " << selectedUnit->getAttackDamage() << " damage!" << std::endl;
-                    if (!targetEnemy->isAlive()) {
-                        std::cout << "Enemy defeated!" << std::endl;
-
-                        // Trigger explosion animation at the defeated unit's location
-                        Explosion explosion = { { targetEnemy->getX() * TILE_SIZE, targetEnemy->getY() * TILE_SIZE }, 0, true };
-                        explosions.push_back(explosion);
-                    } else {
-                        std::cout << "Enemy health: " << targetEnemy->getHealth() << std::endl;
-                    }
-                } else {
-                    selectedUnit->setPosition(destination.x, destination.y);
-                }
+    auto lastTick = std::chrono::steady_clock::now();
+    while (running) {
+        // Let the previous move finish playing before the AI picks the next one
+        if (ai && options.aiPlayers[state.getCurrentPlayer()] && !aiSearch.valid() && !aiStuck &&
+            state.getWinner() == 0 && animations.isIdle()) {
+            aiSearch = std::async(std::launch::async, [&ai, &aiAction, snapshot = state]() {
+                return ai->chooseAction(snapshot, aiAction);
+            });
+        }
 
-                // End turn, reset selection, and switch players
-                selectedUnit = nullptr;
-                movementRange.clear();
-                attackRange.clear();
-                destination = {-1, -1};
-                targetEnemy = nullptr;
-                currentPlayer = (currentPlayer == 1) ? 2 : 1;  // Switch turns
+        // Sleep until input arrives; while animating, only until the next step is due
+        bool idle = animations.isIdle() && !gameRenderer.needsRedraw();
+        bool gotEvent = idle && !aiSearch.valid() ? SDL_WaitEvent(&event) != 0
+                      : SDL_WaitEventTimeout(&event, idle ? AI_POLL_MS : static_cast<int>(animations.msUntilNextStep())) != 0;
+        profiler.beginFrame();
+        AllocationScope frameAllocations;
+        if (gotEvent) {
+            BATTLE_PROFILE_SCOPE("events");
+            handleEvent(event);
+            while (SDL_PollEvent(&event)) {
+                handleEvent(event);
             }
-            SDL_Delay(50);  // Animation delay
         }
-    }
-
-    IMG_Quit();
-    SDL_DestroyRenderer(renderer);
-    SDL_DestroyWindow(window);
-    SDL_Quit();
-    return 0;
-}
-
-// BFS-based range calculation
-std::vector<SDL_Point> calculateMovementRange(const Unit& unit, const Map& map, const std::vector<Unit>& units) {
-    int maxRange = unit.getMoveRange();
-    std::vector<SDL_Point> rangePoints;
-    std::queue<std::pair<int, int>> toVisit;
-    toVisit.push({unit.getX(), unit.getY()});
-    std::vector<std::vector<int>> visited(map.getWidth(), std::vector<int>(map.getHeight(), -1));
-    visited[unit.getX()][unit.getY()] = 0;
-
-    while (!toVisit.empty()) {
-        auto [cx, cy] = toVisit.front();
-        toVisit.pop();
-        int distance = visited[cx][cy];
-
-        if (distance >= maxRange) continue;
-
-        std::vector<std::pair<int, int>> directions = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
-        for (const auto& [dx, dy] : directions) {
-            int nx = cx + dx;
-            int ny = cy + dy;
-
-            if (nx >= 0 && ny >= 0 && nx < map.getWidth() && ny < map.getHeight() && visited[nx][ny] == -1) {
-                Tile tile = map.getTile(nx, ny);
-                bool passable = false;
-                switch (unit.getType()) {
-                    case TANK: passable = tile.passableByTank; break;
-                    case INFANTRY: passable = tile.passableByInfantry; break;
-                    case BOAT: passable = tile.passableByBoat; break;
-                    case HELICOPTER: passable = tile.passableByHelicopter; break;
-                }
-
-                                // Check if the tile is occupied by an enemy unit
-                bool occupiedByEnemy = false;
-                for (const Unit& enemyUnit : units) {
-                    if (enemyUnit.getX() == nx && enemyUnit.getY() == ny && enemyUnit.getPlayer() != unit.getPlayer() && enemyUnit.isAlive()) {
-                        occupiedByEnemy = true;
-                        break;
-                    }
-                }
-
-                if (passable && !occupiedByEnemy) {
-                    visited[nx][ny] = distance + 1;
-                    toVisit.push({nx, ny});
-                    rangePoints.push_back({nx, ny});
-                }
 
+        // Time spent asleep while idle must not fast-forward a freshly started animation
+        auto now = std::chrono::steady_clock::now();
+        double elapsedMs = idle ? 0.0 : std::chrono::duration<double, std::milli>(now - lastTick).count();
+        {
+            BATTLE_PROFILE_SCOPE("animations");
+            animations.update(elapsedMs, state);
+        }
+        lastTick = now;
+
+        if (aiSearch.valid() && aiSearch.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+            int player = state.getCurrentPlayer();
+            if (aiSearch.get()) {
+                const UnitPool& units = state.getUnits();
+                applyCommand({SELECT, units.getX(aiAction.unitIndex), units.getY(aiAction.unitIndex)});
+                applyCommand({aiAction.type, aiAction.x, aiAction.y});
+                const AiStats& stats = ai->getLastStats();
+                std::cout << "AI player " << player << ": depth " << stats.depth << ", " << stats.nodes << " nodes, "
+                          << static_cast<long>(stats.nodesPerSecond()) << " nodes/s" << std::endl;
+            } else {
+                std::cout << "AI player " << player << " has no move left." << std::endl;
+                aiStuck = true;
             }
         }
-    }
-    return rangePoints;
-}
 
-std::vector<SDL_Point> calculateAttackRange(const Unit& unit, const Map& map) {
-    int maxRange = unit.getAttackRange();
-    std::vector<SDL_Point> rangePoints;
-    // need to return all tiles within range of the unit, including those on diagonals
-    for (int dx = -maxRange; dx <= maxRange; dx++) {
-        for (int dy = -maxRange; dy <= maxRange; dy++) {
-            if (dx == 0 && dy == 0) continue;
-            int nx = unit.getX() + dx;
-            int ny = unit.getY() + dy;
-            if (nx >= 0 && ny >= 0 && nx < map.getWidth() && ny < map.getHeight()) {
-                rangePoints.push_back({nx, ny});
+        // Render game; skipped entirely when nothing changed since the last frame
+        bool drawn;
+        {
+            BATTLE_PROFILE_SCOPE("render");
+            drawn = gameRenderer.renderFrame(state, animations);
+        }
+        if (drawn) {
+            framesDrawn++;
+            drawCallsTotal += gameRenderer.getLastDrawCalls();
+            textureSwitchesTotal += gameRenderer.getLastTextureSwitches();
+            uint64_t allocations = frameAllocations.allocations();
+            if (framesDrawn > 1 && allocations > 0) {
+                framesAllocating++;
+                frameAllocationsTotal += allocations;
             }
+            profiler.endFrame(gameRenderer.getLastDrawCalls());
         }
     }
-    return rangePoints;
-}
 
-bool loadUnits(const std::string& filename, int player, SDL_Renderer* renderer, std::vector<Unit>& units) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        std::cerr << "Unable to open unit file: " << filename << std::endl;
-        return false;
+    if (!options.traceFile.empty()) {
+        profiler.exportChromeTrace(options.traceFile);
+    }
+    if (!options.recordFile.empty() && commandLog.save(options.recordFile)) {
+        std::cout << "Recorded " << commandLog.getTurnCount() << " turns to " << options.recordFile << std::endl;
     }
 
-    char unitTypeChar;
-    int x, y, orientation;
-    SDL_Texture* spriteSheet = nullptr;
-
-    while (file >> unitTypeChar >> x >> y >> orientation) {
-        UnitType type;
-        switch (unitTypeChar) {
-            case 'I':
-                spriteSheet = IMG_LoadTexture(renderer, player == 1 ? "resources/gfx/infantry_spritesheet_p1.png" : "resources/gfx/infantry_spritesheet_p2.png");
-                type = INFANTRY;
-                break;
-            case 'T':
-                spriteSheet = IMG_LoadTexture(renderer, player == 1 ? "resources/gfx/tank_spritesheet_p1.png" : "resources/gfx/tank_spritesheet_p2.png");
-                type = TANK;
-                break;
-            case 'B':
-                spriteSheet = IMG_LoadTexture(renderer, player == 1 ? "resources/gfx/boat_spritesheet_p1.png" : "resources/gfx/boat_spritesheet_p2.png");
-                type = BOAT;
-                break;
-            case 'H':
-                spriteSheet = IMG_LoadTexture(renderer, player == 1 ? "resources/gfx/helicopter_spritesheet_p1.png" : "resources/gfx/helicopter_spritesheet_p2.png");
-                type = HELICOPTER;
-                break;
-            default:
-                continue;
-        }
-
-        if (!spriteSheet) {
-            std::cerr << "Failed to load spritesheet for " << unitTypeChar << " for player " << player << std::endl;
-            continue;
+    if (framesDrawn > 0) {
+        std::cout << "Drew " << framesDrawn << " frames, " << static_cast<double>(drawCallsTotal) / framesDrawn
+                  << " draw calls and " << static_cast<double>(textureSwitchesTotal) / framesDrawn
+                  << " texture switches per frame on average ("
+                  << (gameRenderer.getSprites().isPacked() ? "packed atlas" : "loose images") << ")" << std::endl;
+        if (allocationCountingEnabled()) {
+            std::cout << "Heap allocations: " << framesAllocating << " of " << framesDrawn - 1
+                      << " frames after the first allocated, " << frameAllocationsTotal << " in total" << std::endl;
         }
-
-        units.emplace_back(type, x, y, player, orientation, spriteSheet);
     }
-
-    return true;
+    const ReachabilityStats& reach = state.getReachabilityStats();
+    std::cout << "Range cache: " << reach.hits << " hits, " << reach.misses << " misses, "
+              << reach.recomputes << " recomputes, " << reach.invalidations << " invalidations" << std::endl;
+    const FogStats& fogStats = fog.getStats();
+    std::cout << "Fog of war: " << fogStats.updates << " updates, " << fogStats.sightsCast << " fields of view cast" << std::endl;
+    if (threatsBuilt) {
+        const ThreatStats& threatStats = threats.getStats();
+        std::cout << "Threat map: " << threatStats.updates << " updates, " << threatStats.unitsRecomputed << " reaches recomputed" << std::endl;
+    }
+    return 0;
 }
@@ -0,0 +1,101 @@
+#include "map_renderer.hpp"
+#include <algorithm>
+#include <iostream>
+#include "draw.hpp"
+
+MapRenderer::MapRenderer(int tileSize, const SpriteAtlas& sprites)
+    : tileSize(tileSize), sprites(sprites) {}
+
+SDL_Texture* MapRenderer::chunkTexture(SDL_Renderer* renderer, const Map& map, int chunkX, int chunkY) {
+    if (targetsUnsupported) return nullptr;
+
+    int64_t key = static_cast<int64_t>(chunkY) << 32 | static_cast<uint32_t>(chunkX);
+    auto it = chunks.find(key);
+    if (it != chunks.end()) {
+        it->second.lastUsed = frame;
+        return it->second.texture.get();
+    }
+
+    int chunkPixels = CHUNK_TILES * tileSize;
+    SDL_Texture* texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, chunkPixels, chunkPixels);
+    if (!texture) {
+        std::cerr << "Terrain chunks unavailable, drawing tiles individually: " << SDL_GetError() << std::endl;
+        targetsUnsupported = true;
+        return nullptr;
+    }
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_NONE);
+
+    SDL_Texture* previousTarget = SDL_GetRenderTarget(renderer);
+    SDL_SetRenderTarget(renderer, texture);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+    SDL_RenderClear(renderer);
+    int left = chunkX * CHUNK_TILES, top = chunkY * CHUNK_TILES;
+    drawTiles(renderer, map, left, top,
+              std::min(map.getWidth(), left + CHUNK_TILES) - 1, std::min(map.getHeight(), top + CHUNK_TILES) - 1,
+              nullptr, left, top);
+    SDL_SetRenderTarget(renderer, previousTarget);
+
+    Chunk& chunk = chunks[key];
+    chunk.texture.reset(texture, SDL_DestroyTexture);
+    chunk.lastUsed = frame;
+    return texture;
+}
+
+void MapRenderer::drawTiles(SDL_Renderer* renderer, const Map& map, int left, int top, int right, int bottom,
+                            const Camera* camera, int originX, int originY) {
+    for (int y = top; y <= bottom; y++) {
+        for (int x = left; x <= right; x++) {
+            int sprite = terrainSprite(map.getTerrain(x, y));
+            if (camera) {
+                sprites.draw(renderer, *camera, sprite, (x - originX) * tileSize, (y - originY) * tileSize);
+            } else {
+                sprites.drawLocal(renderer, sprite, (x - originX) * tileSize, (y - originY) * tileSize);
+            }
+        }
+    }
+}
+
+void MapRenderer::render(SDL_Renderer* renderer, const Map& map, const Camera& camera, Arena& frameArena) {
+    frame++;
+    int left, top, right, bottom;
+    camera.visibleTiles(tileSize, map.getWidth(), map.getHeight(), left, top, right, bottom);
+    if (left > right || top > bottom) return;
+
+    int chunkPixels = CHUNK_TILES * tileSize;
+    for (int chunkY = top / CHUNK_TILES; chunkY <= bottom / CHUNK_TILES; chunkY++) {
+        for (int chunkX = left / CHUNK_TILES; chunkX <= right / CHUNK_TILES; chunkX++) {
+            SDL_Texture* texture = chunkTexture(renderer, map, chunkX, chunkY);
+            if (!texture) {
+                drawTiles(renderer, map, left, top, right, bottom, &camera, 0, 0);
+                return;
+            }
+            SDL_Rect destRect = camera.toScreen({ chunkX * chunkPixels, chunkY * chunkPixels, chunkPixels, chunkPixels });
+            drawTexture(renderer, texture, nullptr, &destRect);
+        }
+    }
+    evict(frameArena);
+}
+
+void MapRenderer::renderTile(SDL_Renderer* renderer, const Map& map, const Camera& camera, int x, int y) {
+    SDL_Texture* texture = chunkTexture(renderer, map, x / CHUNK_TILES, y / CHUNK_TILES);
+    if (texture) {
+        SDL_Rect srcRect = { (x % CHUNK_TILES) * tileSize, (y % CHUNK_TILES) * tileSize, tileSize, tileSize };
+        SDL_Rect destRect = camera.toScreen({ x * tileSize, y * tileSize, tileSize, tileSize });
+        drawTexture(renderer, texture, &srcRect, &destRect);
+    } else {
+        sprites.draw(renderer, camera, terrainSprite(map.getTerrain(x, y)), x * tileSize, y * tileSize);
+    }
+}
+
+void MapRenderer::evict(Arena& frameArena) {
+    if (chunks.size() <= MAX_CHUNKS) return;
+    std::pair<uint64_t, int64_t>* byAge = frameArena.allocateArray<std::pair<uint64_t, int64_t>>(chunks.size());
+    size_t count = 0;
+    for (const auto& [key, chunk] : chunks) {
+        if (chunk.lastUsed != frame) byAge[count++] = {chunk.lastUsed, key};
+    }
+    std::sort(byAge, byAge + count);
+    for (size_t i = 0; i < count && chunks.size() > MAX_CHUNKS; i++) {
+        chunks.erase(byAge[i].second);
+    }
+}
@@ -0,0 +1,107 @@
+#include "profiler_overlay.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include "allocation_counter.hpp"
+#include "draw.hpp"
+
+namespace {
+
+const int GLYPH_WIDTH = 3;
+const int GLYPH_HEIGHT = 5;
+const int CHAR_ADVANCE = (GLYPH_WIDTH + 1) * ProfilerOverlay::PIXEL_SIZE;
+const int LINE_HEIGHT = (GLYPH_HEIGHT + 2) * ProfilerOverlay::PIXEL_SIZE;
+const int PADDING = 6;
+const size_t LINE_CHARS = 96;
+
+struct Glyph {
+    char character;
+    const char* rows;  // GLYPH_HEIGHT rows of GLYPH_WIDTH pixels, top to bottom
+};
+
+const Glyph FONT[] = {
+    {'0', "111101101101111"}, {'1', "010110010010111"}, {'2', "111001111100111"}, {'3', "111001111001111"},
+    {'4', "101101111001001"}, {'5', "111100111001111"}, {'6', "111100111101111"}, {'7', "111001001001001"},
+    {'8', "111101111101111"}, {'9', "111101111001111"}, {'A', "010101111101101"}, {'B', "110101110101110"},
+    {'C', "011100100100011"}, {'D', "110101101101110"}, {'E', "111100110100111"}, {'F', "111100110100100"},
+    {'G', "011100101101011"}, {'H', "101101111101101"}, {'I', "111010010010111"}, {'J', "001001001101010"},
+    {'K', "101101110101101"}, {'L', "100100100100111"}, {'M', "101111111101101"}, {'N', "110101101101101"},
+    {'O', "010101101101010"}, {'P', "110101110100100"}, {'Q', "010101101110011"}, {'R', "110101110101101"},
+    {'S', "011100010001110"}, {'T', "111010010010010"}, {'U', "101101101101111"}, {'V', "101101101101010"},
+    {'W', "101101111111101"}, {'X', "101101010101101"}, {'Y', "101101010010010"}, {'Z', "111001010100111"},
+    {'.', "000000000000010"}, {':', "000010000010000"}, {'-', "000000111000000"}, {'_', "000000000000111"},
+    {'/', "001001010100100"}, {'%', "101001010100101"},
+};
+
+const char* glyphRows(char character) {
+    char upper = static_cast<char>(std::toupper(static_cast<unsigned char>(character)));
+    for (const Glyph& glyph : FONT) {
+        if (glyph.character == upper) return glyph.rows;
+    }
+    return nullptr;  // blank
+}
+
+const char* format(Arena& arena, const char* pattern, ...) {
+    char* line = arena.allocateArray<char>(LINE_CHARS);
+    va_list arguments;
+    va_start(arguments, pattern);
+    std::vsnprintf(line, LINE_CHARS, pattern, arguments);
+    va_end(arguments);
+    return line;
+}
+
+}
+
+void ProfilerOverlay::addText(const char* text, int x, int y) {
+    for (size_t i = 0; text[i] != '\0'; i++) {
+        const char* rows = glyphRows(text[i]);
+        if (!rows) continue;
+        int charX = x + static_cast<int>(i) * CHAR_ADVANCE;
+        for (int row = 0; row < GLYPH_HEIGHT; row++) {
+            for (int column = 0; column < GLYPH_WIDTH; column++) {
+                if (rows[row * GLYPH_WIDTH + column] == '1') {
+                    glyphRects.push_back({charX + column * PIXEL_SIZE, y + row * PIXEL_SIZE, PIXEL_SIZE, PIXEL_SIZE});
+                }
+            }
+        }
+    }
+}
+
+void ProfilerOverlay::draw(SDL_Renderer* renderer, Arena& frameArena, int x, int y) {
+    const Profiler& profiler = Profiler::instance();
+    FrameTimings frame = profiler.getFrameTimings();
+
+    lines.clear();
+    lines.push_back(format(frameArena, "frame %.2f ms  p50 %.2f  p95 %.2f  p99 %.2f  max %.2f",
+                           frame.lastMs, frame.p50Ms, frame.p95Ms, frame.p99Ms, frame.maxMs));
+    lines.push_back(format(frameArena, "draw calls %d  frames %d", frame.drawCalls, frame.frames));
+    if (allocationCountingEnabled()) {
+        lines.push_back(format(frameArena, "heap allocs %llu", static_cast<unsigned long long>(frame.allocations)));
+    }
+#ifdef BATTLE_PROFILING
+    profiler.getSectionTimings(sections);
+    for (const SectionTiming& section : sections) {
+        lines.push_back(format(frameArena, "%-15s %.3f ms  avg %.3f  x%d", section.name, section.lastMs, section.averageMs, section.calls));
+    }
+#else
+    lines.push_back("section timers compiled out");
+#endif
+
+    size_t longest = 0;
+    for (const char* line : lines) {
+        longest = std::max(longest, std::strlen(line));
+    }
+    SDL_Rect panel = {x, y, static_cast<int>(longest) * CHAR_ADVANCE + 2 * PADDING,
+                      static_cast<int>(lines.size()) * LINE_HEIGHT + 2 * PADDING};
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 176);
+    drawFilledRect(renderer, &panel);
+
+    glyphRects.clear();
+    for (size_t i = 0; i < lines.size(); i++) {
+        addText(lines[i], x + PADDING, y + PADDING + static_cast<int>(i) * LINE_HEIGHT);
+    }
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+    drawFilledRects(renderer, glyphRects.data(), static_cast<int>(glyphRects.size()));
+}
@@ -0,0 +1,89 @@
+#include "sprite_atlas.hpp"
+#include <algorithm>
+#include <iostream>
+#include "atlas_layout.hpp"
+#include "draw.hpp"
+
+bool SpriteAtlas::loadPacked(const std::string& layoutFile, int tileSize, AssetCache& assets) {
+    AtlasLayout layout;
+    if (!loadAtlasLayout(layoutFile, layout)) return false;
+    if (layout.tileSize != tileSize) {
+        std::cerr << "Atlas " << layoutFile << " was packed for " << layout.tileSize << " px tiles, not " << tileSize << std::endl;
+        return false;
+    }
+
+    std::vector<std::shared_ptr<SDL_Texture>> pages;
+    for (const AtlasPage& page : layout.pages) {
+        std::shared_ptr<SDL_Texture> texture = assets.getTexture(page.file);
+        if (!texture) return false;
+        pages.push_back(texture);
+    }
+
+    sprites.assign(SPRITE_COUNT, Sprite());
+    for (int sprite = 0; sprite < SPRITE_COUNT; sprite++) {
+        const AtlasSprite& placed = layout.sprites[sprite];
+        if (placed.page == -1) continue;
+        sprites[sprite] = {pages[placed.page].get(), {placed.x, placed.y, placed.w, placed.h},
+                           {placed.offsetX, placed.offsetY, placed.w, placed.h}};
+    }
+    textures = std::move(pages);
+    packed = true;
+    return true;
+}
+
+bool SpriteAtlas::loadLoose(int tileSize, AssetCache& assets) {
+    textures.clear();
+    sprites.assign(SPRITE_COUNT, Sprite());
+    packed = false;
+
+    bool ok = true;
+    for (int sprite = 0; sprite < SPRITE_COUNT; sprite++) {
+        SpriteSource source = spriteSource(sprite, tileSize);
+        std::shared_ptr<SDL_Texture> texture = assets.getTexture(source.path);
+        if (!texture) {
+            ok = false;
+            continue;
+        }
+        if (std::find(textures.begin(), textures.end(), texture) == textures.end()) {
+            textures.push_back(texture);
+        }
+        if (source.source.w == 0) {
+            SDL_QueryTexture(texture.get(), nullptr, nullptr, &source.source.w, &source.source.h);
+        }
+        sprites[sprite] = {texture.get(), {source.source.x, source.source.y, source.source.w, source.source.h},
+                           {source.box.x, source.box.y, source.box.w, source.box.h}};
+    }
+    return ok;
+}
+
+void SpriteAtlas::draw(SDL_Renderer* renderer, const Camera& camera, int sprite, int x, int y) const {
+    const Sprite& drawn = sprites[sprite];
+    if (!drawn.texture) return;
+    SDL_Rect destRect = camera.toScreen({x + drawn.box.x, y + drawn.box.y, drawn.box.w, drawn.box.h});
+    drawTexture(renderer, drawn.texture, &drawn.source, &destRect);
+}
+
+void SpriteAtlas::drawLocal(SDL_Renderer* renderer, int sprite, int x, int y) const {
+    const Sprite& drawn = sprites[sprite];
+    if (!drawn.texture) return;
+    SDL_Rect destRect = {x + drawn.box.x, y + drawn.box.y, drawn.box.w, drawn.box.h};
+    drawTexture(renderer, drawn.texture, &drawn.source, &destRect);
+}
+
+std::vector<std::string> SpriteAtlas::imagePaths(const std::string& layoutFile, int tileSize) {
+    std::vector<std::string> paths;
+    AtlasLayout layout;
+    if (!layoutFile.empty() && loadAtlasLayout(layoutFile, layout) && layout.tileSize == tileSize) {
+        for (const AtlasPage& page : layout.pages) {
+            paths.push_back(page.file);
+        }
+        return paths;
+    }
+    for (int sprite = 0; sprite < SPRITE_COUNT; sprite++) {
+        std::string path = spriteSource(sprite, tileSize).path;
+        if (std::find(paths.begin(), paths.end(), path) == paths.end()) {
+            paths.push_back(path);
+        }
+    }
+    return paths;
+}
@@ -0,0 +1,12 @@
+#include "unit_renderer.hpp"
+
+UnitRenderer::UnitRenderer(int tileSize, const SpriteAtlas& sprites)
+    : tileSize(tileSize), sprites(sprites) {}
+
+void UnitRenderer::render(SDL_Renderer* renderer, const Camera& camera, const Unit& unit, int x, int y) const {
+    renderAt(renderer, camera, unit, x * tileSize, y * tileSize);
+}
+
+void UnitRenderer::renderAt(SDL_Renderer* renderer, const Camera& camera, const Unit& unit, int pixelX, int pixelY) const {
+    sprites.draw(renderer, camera, unitSprite(unit.getType(), unit.getPlayer(), unit.getOrientation()), pixelX, pixelY);
+}
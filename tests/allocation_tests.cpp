@@ -0,0 +1,118 @@
+#include "allocation_counter.hpp"
+#include "animation_scheduler.hpp"
+#include "arena.hpp"
+#include "command_log.hpp"
+#include "fog_of_war.hpp"
+#include "test.hpp"
+#include "test_fixtures.hpp"
+
+namespace {
+
+// The game loop's work for a recorded match, minus the drawing: every command
+// as a click, with the walk, explosion and fog updates the game makes for it,
+// then a few frames of animation steps, the tiles they cover, the movement
+// range shown under fog and the highlights remembered for the next frame
+struct HeadlessGame {
+    static const int FRAMES_PER_COMMAND = 4;
+
+    AnimationScheduler animations;
+    FogOfWar fog;
+    Arena frameArena;
+    BitGrid knownOccupied;
+    std::vector<Point> path, shownMovement, highlights, animationTiles, drawnAnimationTiles;
+    long frames = 0;
+    long framesAllocating = 0;
+
+    void play(GameState& state, const CommandLog& log) {
+        fog.rebuild(state);
+        size_t offset = 0;
+        LoggedCommand entry;
+        AllocationScope allocations;
+        while (log.next(offset, entry)) {
+            int player = state.getCurrentPlayer();
+            StepResult result = state.step(entry.command);
+            if (result.outcome == MOVED) {
+                if (!state.findPath(result.unitIndex, result.from, result.to, path)) path.assign({result.from, result.to});
+                animations.startMove(state.getHandle(result.unitIndex), path);
+                fog.unitMoved(state, result.unitIndex, result.from, result.to);
+            } else if (result.killed) {
+                fog.unitRemoved(state, player == 1 ? 2 : 1, result.to);
+                animations.startExplosion(result.to);
+            }
+            for (int i = 0; i < FRAMES_PER_COMMAND; i++) {
+                frame(state);
+                if (allocations.allocations() != 0) framesAllocating++;
+                allocations.restart();
+            }
+        }
+        // Let the last walks and explosions finish
+        while (!animations.isIdle()) animations.update(AnimationScheduler::STEP_MS, state);
+    }
+
+    void frame(GameState& state) {
+        frames++;
+        frameArena.reset();
+        // Per-frame scratch, as the terrain chunk eviction takes
+        frameArena.allocateArray<uint64_t>(1024);
+        animations.update(AnimationScheduler::STEP_MS, state);
+        animationTiles.clear();
+        animations.coveredTiles(64, animationTiles);
+        drawnAnimationTiles.swap(animationTiles);
+        int viewer = state.getCurrentPlayer();
+        int index = state.getSelectedIndex();
+        if (index != -1 && state.getUnits().getPlayer(index) == viewer) {
+            fog.knownMovementRange(state, viewer, index, knownOccupied, shownMovement);
+        } else {
+            shownMovement = state.getMovementRange();
+        }
+        highlights = shownMovement;
+        highlights.insert(highlights.end(), state.getAttackRange().begin(), state.getAttackRange().end());
+    }
+};
+
+}
+
+// Once the range cache and scratch buffers have grown, replaying the same
+// match again must not touch the heap at all
+TEST(allocation_free_warm_replay) {
+    CHECK(allocationCountingEnabled());
+    for (int size : {12, 16, 32, 48}) {
+        GameState initial = randomBattle(size, size, size * 3 + 1, 12);
+        GameState played = initial;
+        CommandLog log = recordRandomGame(played, 3000, size);
+        CHECK(log.getTurnCount() > 0);
+
+        // Assigned rather than copied, so the state keeps its buffers
+        GameState state(0, 0);
+        state = initial;
+        ReplayResult cold = log.replay(state);
+        CHECK(cold.ok);
+        state = initial;
+        ReplayResult warm = log.replay(state);
+        CHECK(warm.ok);
+        CHECK(warm.turns == log.getTurnCount());
+        CHECK(warm.allocations == 0);
+    }
+}
+
+// Frames of a running game: after one pass over a match has grown every
+// buffer, the same match played again allocates in none of its frames
+TEST(allocation_free_warm_frames) {
+    for (int size : {16, 32}) {
+        GameState initial = randomBattle(size, size, size * 5 + 2, 12);
+        GameState played = initial;
+        CommandLog log = recordRandomGame(played, 500, size);
+        CHECK(log.getTurnCount() > 0);
+
+        HeadlessGame game;
+        GameState state(0, 0);
+        state = initial;
+        game.play(state, log);
+        state = initial;
+        game.framesAllocating = 0;
+        game.frames = 0;
+        game.play(state, log);
+        CHECK(game.frames > 0);
+        CHECK(game.framesAllocating == 0);
+    }
+}
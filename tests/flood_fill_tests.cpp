@@ -0,0 +1,113 @@
+#include <algorithm>
+#include <random>
+#include "flood_fill.hpp"
+#include "game_state.hpp"
+#include "test.hpp"
+#include "test_fixtures.hpp"
+
+namespace {
+
+std::vector<Point> sorted(std::vector<Point> tiles) {
+    std::sort(tiles.begin(), tiles.end(), [](const Point& a, const Point& b) { return a.y != b.y ? a.y < b.y : a.x < b.x; });
+    return tiles;
+}
+
+bool sameTiles(const std::vector<Point>& a, const std::vector<Point>& b) {
+    std::vector<Point> first = sorted(a), second = sorted(b);
+    return first.size() == second.size() && std::equal(first.begin(), first.end(), second.begin(), [](const Point& p, const Point& q) {
+        return p.x == q.x && p.y == q.y;
+    });
+}
+
+// A random battle of random density, its terrain then scrambled tile by tile
+// so that ranges are cut up far more than on generated maps and units end up
+// on terrain they can't enter
+GameState randomBoard(std::mt19937& rng, int width, int height) {
+    GameState state = randomBattle(width, height, rng(), 1 + rng() % 6);
+    Map& map = state.getMutableMap();
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            map.setTerrain(x, y, static_cast<TerrainType>(rng() % TERRAIN_TYPE_COUNT));
+        }
+    }
+    return state;
+}
+
+// Every unit's range from the per-type bitset kernel, the scalar BFS over the
+// same bitsets and the unit-scan BFS (movementRangeScan) must be the same set
+void checkEveryUnit(const GameState& state) {
+    const Map& map = state.getMap();
+    const UnitPool& units = state.getUnits();
+    const OccupancyGrid& occupancy = state.getOccupancy();
+    std::vector<Point> bitset, scalar, scan;
+    for (int i = 0; i < units.size(); i++) {
+        Unit unit = units.get(i);
+        const BitGrid& passable = map.getPassability(unit.getType());
+        const BitGrid& friendly = occupancy.getPlayerTiles(unit.getPlayer());
+        bitset.clear();
+        forUnitType(unit.getType(), [&](auto type) {
+            floodFillRangeOf<decltype(type)::value>(passable, occupancy.getOccupied(), friendly, unit.getX(), unit.getY(), bitset);
+        });
+        scalar.clear();
+        floodFillRangeScalar(passable, occupancy.getOccupied(), friendly, unit.getX(), unit.getY(), unit.getMoveRange(), scalar);
+        calculateMovementRange(unit, map, units, scan);
+        CHECK(sameTiles(bitset, scalar));
+        CHECK(sameTiles(scan, scalar));
+    }
+}
+
+}
+
+TEST(flood_fill_matches_bfs_on_random_boards) {
+    std::mt19937 rng(2024);
+    // Small boards put most units against an edge; widths past 64 make the
+    // window straddle a word boundary of the grids
+    for (int board = 0; board < 200; board++) {
+        int width = 1 + rng() % (board % 3 == 0 ? 150 : 20);
+        int height = 1 + rng() % 24;
+        checkEveryUnit(randomBoard(rng, width, height));
+    }
+}
+
+TEST(flood_fill_matches_bfs_at_word_borders) {
+    std::mt19937 rng(7);
+    // Every type at each column around the 64-tile word borders and the map edges
+    for (int width : {63, 64, 65, 127, 128, 129, 200}) {
+        for (int trial = 0; trial < 6; trial++) {
+            GameState state = randomBoard(rng, width, 12);
+            for (int x : {0, 1, 5, 58, 62, 63, 64, 65, 70, 126, 127, 128, 129, width - 2, width - 1}) {
+                if (x < 0 || x >= width) continue;
+                int y = rng() % 12;
+                if (state.unitAt(x, y) != -1) continue;
+                state.addUnit(Unit(static_cast<UnitType>(rng() % UNIT_TYPE_COUNT), x, y, 1 + rng() % 2, 0));
+            }
+            checkEveryUnit(state);
+        }
+    }
+}
+
+// The batch call over a random subset of the pool, duplicates and all, gives
+// each index the range the scalar BFS finds for that unit alone
+TEST(flood_fill_batch_matches_per_unit_ranges) {
+    std::mt19937 rng(99);
+    std::vector<std::vector<Point>> ranges;
+    std::vector<Point> scalar;
+    for (int board = 0; board < 60; board++) {
+        GameState state = randomBoard(rng, 1 + rng() % 100, 1 + rng() % 24);
+        const UnitPool& units = state.getUnits();
+        const OccupancyGrid& occupancy = state.getOccupancy();
+        if (units.size() == 0) continue;
+        std::vector<int> indices;
+        for (int i = 0; i < units.size() * 3 / 2; i++) indices.push_back(rng() % units.size());
+        floodFillRanges(units, indices, state.getMap(), occupancy, ranges);
+        CHECK(ranges.size() == indices.size());
+        for (size_t i = 0; i < indices.size() && i < ranges.size(); i++) {
+            int unit = indices[i];
+            scalar.clear();
+            floodFillRangeScalar(state.getMap().getPassability(units.getType(unit)), occupancy.getOccupied(),
+                                 occupancy.getPlayerTiles(units.getPlayer(unit)), units.getX(unit), units.getY(unit),
+                                 units.getMoveRange(unit), scalar);
+            CHECK(sameTiles(ranges[i], scalar));
+        }
+    }
+}
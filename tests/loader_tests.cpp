@@ -0,0 +1,152 @@
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include "binary_layout.hpp"
+#include "game_state.hpp"
+#include "test.hpp"
+
+namespace {
+
+// A 4x4 map file whose header is patched by `edit`
+bool loadPatchedMap(void (*edit)(MapFileHeader&)) {
+    Map map(4, 4);
+    if (!map.saveBinaryMap("loader_tests.bmap")) return false;
+    std::fstream file("loader_tests.bmap", std::ios::in | std::ios::out | std::ios::binary);
+    MapFileHeader header;
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    edit(header);
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.close();
+    Map loaded(1, 1);
+    return loaded.loadMap("loader_tests.bmap");
+}
+
+// The same file with word `word` of the stored passability grids XORed with `bits`
+bool loadFlippedPassability(size_t word, uint64_t bits) {
+    Map map(4, 4);
+    map.setTerrain(1, 2, WATER);
+    if (!map.saveBinaryMap("loader_tests.bmap")) return false;
+    std::fstream file("loader_tests.bmap", std::ios::in | std::ios::out | std::ios::binary);
+    MapFileHeader header;
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    uint64_t stored;
+    file.seekg(header.passabilityOffset + word * sizeof(stored));
+    file.read(reinterpret_cast<char*>(&stored), sizeof(stored));
+    stored ^= bits;
+    file.seekp(header.passabilityOffset + word * sizeof(stored));
+    file.write(reinterpret_cast<const char*>(&stored), sizeof(stored));
+    file.close();
+    Map loaded(1, 1);
+    return loaded.loadMap("loader_tests.bmap");
+}
+
+bool loadUnitLines(const char* lines) {
+    {
+        std::ofstream file("loader_tests_units.txt");
+        file << lines;
+    }
+    GameState state(4, 4);
+    bool ok = state.loadUnits("loader_tests_units.txt", 1);
+    CHECK(ok || state.getUnits().empty());
+    return ok;
+}
+
+bool loadBinaryUnit(const Unit& unit) {
+    if (!saveBinaryUnits({Unit(INFANTRY, 0, 0, 1, 0), unit}, "loader_tests.bunits")) return false;
+    GameState state(4, 4);
+    bool ok = state.loadUnits("loader_tests.bunits", 1);
+    CHECK(ok || state.getUnits().empty());
+    return ok;
+}
+
+}
+
+TEST(loader_rejects_map_offsets_that_wrap) {
+    CHECK(loadPatchedMap([](MapFileHeader&) {}));
+    // Offsets that only pass a summed bounds check by wrapping past 2^64
+    CHECK(!loadPatchedMap([](MapFileHeader& header) { header.terrainOffset = UINT64_MAX - 8; }));
+    CHECK(!loadPatchedMap([](MapFileHeader& header) { header.passabilityOffset = UINT64_MAX - 64; }));
+    CHECK(!loadPatchedMap([](MapFileHeader& header) {
+        header.width = 0xffffffffu;
+        header.height = 0;
+    }));
+}
+
+TEST(loader_rejects_units_outside_the_map) {
+    {
+        std::ofstream file("loader_tests_units.txt");
+        file << "I 1 1 0\nT 3 3 0\n";
+    }
+    GameState state(4, 4);
+    CHECK(state.loadUnits("loader_tests_units.txt", 1));
+    CHECK(state.getUnits().size() == 2);
+
+    for (const char* line : {"I 4 0 0\n", "I 0 -1 0\n", "H 2 40 0\n"}) {
+        {
+            std::ofstream file("loader_tests_units.txt");
+            file << "I 1 2 0\n" << line;
+        }
+        GameState outside(4, 4);
+        CHECK(!outside.loadUnits("loader_tests_units.txt", 1));
+        CHECK(outside.getUnits().empty());
+    }
+
+    // Binary layouts go through the same check
+    std::vector<Unit> units = {Unit(TANK, 2, 2, 1, 0), Unit(BOAT, 9, 1, 2, 0)};
+    CHECK(saveBinaryUnits(units, "loader_tests.bunits"));
+    GameState binary(4, 4);
+    CHECK(!binary.loadUnits("loader_tests.bunits", 1));
+    CHECK(binary.getUnits().empty());
+}
+
+TEST(loader_rejects_corrupt_map_contents) {
+    CHECK(loadFlippedPassability(0, 0));
+    // A tile the terrain says otherwise about, in the first grid and a later one
+    CHECK(!loadFlippedPassability(0, 1));
+    CHECK(!loadFlippedPassability(4 * 2 + 2, uint64_t(1) << 1));
+    // Bits in the row padding past the last column
+    CHECK(!loadFlippedPassability(3, uint64_t(1) << 10));
+    CHECK(!loadFlippedPassability(5, uint64_t(1) << 63));
+
+    int width = 0, height = 0;
+    CHECK(Map::measureMapFile("loader_tests.bmap", width, height));
+    CHECK(!loadPatchedMap([](MapFileHeader& header) { header.version = BINARY_LAYOUT_VERSION + 1; }));
+    CHECK(!Map::measureMapFile("loader_tests.bmap", width, height));
+}
+
+TEST(loader_rejects_bad_players_and_orientations) {
+    CHECK(loadUnitLines("I 1 1 0\nT 2 2 3\n"));
+    CHECK(!loadUnitLines("I 1 1 0\nT 2 2 4\n"));
+    CHECK(!loadUnitLines("I 1 1 -1\n"));
+
+    CHECK(loadBinaryUnit(Unit(TANK, 2, 2, 2, 3)));
+    CHECK(!loadBinaryUnit(Unit(TANK, 2, 2, 255, 0)));
+    CHECK(!loadBinaryUnit(Unit(TANK, 2, 2, 0, 0)));
+    CHECK(!loadBinaryUnit(Unit(TANK, 2, 2, 3, 0)));
+    CHECK(!loadBinaryUnit(Unit(TANK, 2, 2, 1, 4)));
+}
+
+TEST(loader_rejects_stacked_units) {
+    CHECK(!loadUnitLines("I 1 1 0\nT 2 2 0\nH 1 1 0\n"));
+
+    // Against the units already on the board too, e.g. the other player's
+    {
+        std::ofstream file("loader_tests_units.txt");
+        file << "I 1 1 0\nT 2 2 0\n";
+    }
+    GameState state(4, 4);
+    CHECK(state.loadUnits("loader_tests_units.txt", 1));
+    {
+        std::ofstream file("loader_tests_units.txt");
+        file << "B 3 3 0\nT 2 2 0\n";
+    }
+    CHECK(!state.loadUnits("loader_tests_units.txt", 2));
+    CHECK(state.getUnits().size() == 2);
+    {
+        std::ofstream file("loader_tests_units.txt");
+        file << "B 3 3 0\nT 2 3 0\n";
+    }
+    CHECK(state.loadUnits("loader_tests_units.txt", 2));
+    CHECK(state.getUnits().size() == 4);
+}
@@ -0,0 +1,83 @@
+#include <random>
+#include "game_state.hpp"
+#include "test.hpp"
+#include "test_fixtures.hpp"
+
+namespace {
+
+// The grid against a scan of the pool, the way unitAt() used to look units up
+void checkAgainstScan(const GameState& state) {
+    const UnitPool& units = state.getUnits();
+    const OccupancyGrid& occupancy = state.getOccupancy();
+    for (int y = 0; y < occupancy.getHeight(); y++) {
+        for (int x = 0; x < occupancy.getWidth(); x++) {
+            int scanned = OccupancyGrid::EMPTY;
+            for (int i = 0; i < units.size(); i++) {
+                if (units.getX(i) == x && units.getY(i) == y) {
+                    scanned = i;
+                    break;
+                }
+            }
+            CHECK(occupancy.at(x, y) == scanned);
+            CHECK(occupancy.getOccupied().test(x, y) == (scanned != OccupancyGrid::EMPTY));
+            for (int player = 1; player <= 2; player++) {
+                bool held = scanned != OccupancyGrid::EMPTY && units.getPlayer(scanned) == player;
+                CHECK(occupancy.getPlayerTiles(player).test(x, y) == held);
+            }
+        }
+    }
+}
+
+}
+
+TEST(occupancy_matches_unit_scan_through_a_game) {
+    int kills = 0;
+    for (int size : {6, 17, 40}) {
+        std::mt19937 rng(size);
+        GameState state = randomBattle(size, size, size, 5);
+        checkAgainstScan(state);
+
+        // Random moves and attacks, plus units removed and added from outside the rules
+        for (int turn = 0; turn < 400 && state.getWinner() == 0; turn++) {
+            const UnitPool& units = state.getUnits();
+            // Removals can empty both sides, which getWinner() calls no win
+            if (units.empty()) break;
+            int index = rng() % units.size();
+            if (units.getPlayer(index) != state.getCurrentPlayer()) continue;
+            state.step({SELECT, units.getX(index), units.getY(index)});
+            std::vector<Point> attacks = state.getAttackRange(), moves = state.getMovementRange();
+            StepResult result;
+            if (!attacks.empty()) {
+                Point target = attacks[rng() % attacks.size()];
+                result = state.step({ATTACK, target.x, target.y});
+            }
+            if (result.outcome == INVALID_COMMAND && !moves.empty()) {
+                Point target = moves[rng() % moves.size()];
+                result = state.step({MOVE, target.x, target.y});
+            }
+            if (result.killed) kills++;
+            if (result.outcome == INVALID_COMMAND) state.step({SELECT, units.getX(index), units.getY(index)});
+
+            if (turn % 7 == 0 && !units.empty()) state.removeUnit(state.getHandle(rng() % units.size()));
+            if (turn % 5 == 0) {
+                int x = rng() % size, y = rng() % size;
+                if (state.getMap().isPassable(HELICOPTER, x, y) && state.unitAt(x, y) == -1) {
+                    state.addUnit(Unit(HELICOPTER, x, y, 1 + rng() % 2, 0));
+                }
+            }
+            checkAgainstScan(state);
+        }
+    }
+    // A kill moves the last unit into the dead one's index, the case most worth covering
+    CHECK(kills > 0);
+}
+
+TEST(occupancy_refuses_units_added_off_the_map) {
+    GameState state(5, 4);
+    CHECK(state.addUnit(Unit(TANK, 1, 1, 1, 0)) != UnitHandle());
+    for (Point tile : {Point{5, 0}, Point{-1, 2}, Point{2, 4}, Point{0, -7}}) {
+        CHECK(state.addUnit(Unit(HELICOPTER, tile.x, tile.y, 2, 0)) == UnitHandle());
+    }
+    CHECK(state.getUnits().size() == 1);
+    checkAgainstScan(state);
+}
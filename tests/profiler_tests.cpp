@@ -0,0 +1,72 @@
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include "profiler.hpp"
+#include "test.hpp"
+
+// Sections are the frame thread's; a worker's scopes reach the trace only
+TEST(profiler_charges_only_the_frame_thread) {
+    Profiler& profiler = Profiler::instance();
+    profiler.clear();
+    profiler.setEnabled(true);
+
+    profiler.beginFrame();
+    uint64_t now = Profiler::nowNs();
+    profiler.record("frame_work", now, now + 2000000);
+    std::thread worker([&profiler] {
+        for (int i = 0; i < 1000; i++) {
+            uint64_t start = Profiler::nowNs();
+            profiler.record("worker_work", start, start + 1000000);
+        }
+    });
+    worker.join();
+    profiler.endFrame(0);
+
+    std::vector<SectionTiming> sections = profiler.getSectionTimings();
+    CHECK(sections.size() == 1);
+    if (!sections.empty()) {
+        CHECK(std::strcmp(sections[0].name, "frame_work") == 0);
+        CHECK(sections[0].calls == 1);
+        CHECK(sections[0].lastMs == 2.0);
+    }
+
+    // The worker has exited; its events are still in the trace
+    CHECK(profiler.exportChromeTrace("profiler_tests_trace.json"));
+    std::ifstream file("profiler_tests_trace.json");
+    std::stringstream text;
+    text << file.rdbuf();
+    std::string trace = text.str();
+    size_t workerEvents = 0;
+    for (size_t at = trace.find("worker_work"); at != std::string::npos; at = trace.find("worker_work", at + 1)) {
+        workerEvents++;
+    }
+    CHECK(workerEvents == 1000);
+    CHECK(trace.find("frame_work") != std::string::npos);
+    CHECK(trace.find("\"frame\"") != std::string::npos);
+
+    profiler.setEnabled(false);
+    profiler.clear();
+}
+
+// Names are compared by content: the same section from two translation
+// units, or from a copy of the literal, is one section
+TEST(profiler_merges_sections_by_name) {
+    static const char copy[] = "merged_work";
+    Profiler& profiler = Profiler::instance();
+    profiler.clear();
+    profiler.setEnabled(true);
+
+    profiler.beginFrame();
+    uint64_t now = Profiler::nowNs();
+    profiler.record("merged_work", now, now + 1000000);
+    profiler.record(copy, now, now + 1000000);
+    profiler.endFrame(0);
+
+    std::vector<SectionTiming> sections = profiler.getSectionTimings();
+    CHECK(sections.size() == 1);
+    if (!sections.empty()) CHECK(sections[0].calls == 2);
+
+    profiler.setEnabled(false);
+    profiler.clear();
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+// A minimal harness for battle_tests: TEST(name) registers a function,
+// CHECK() reports a failed condition and lets the test carry on. The
+// executable runs every test whose name starts with its first argument.
+
+struct TestRegistration {
+    TestRegistration(const char* name, void (*run)());
+};
+
+void reportFailure(const char* file, int line, const char* expression);
+
+#define TEST(name)                                                 \
+    static void name();                                            \
+    static TestRegistration name##Registration(#name, name);       \
+    static void name()
+
+#define CHECK(condition)                                                    \
+    do {                                                                    \
+        if (!(condition)) reportFailure(__FILE__, __LINE__, #condition);    \
+    } while (0)
@@ -0,0 +1,15 @@
+#include "test_fixtures.hpp"
+#include <random>
+#include "map_generator.hpp"
+
+GameState randomBattle(int width, int height, unsigned seed, int tilesPerUnit) {
+    GameState state(width, height);
+    generateTerrain(state.getMutableMap(), seed);
+    std::mt19937 rng(seed);
+    for (int i = 0; i < width * height / tilesPerUnit; i++) {
+        int x = rng() % width, y = rng() % height;
+        UnitType type = static_cast<UnitType>(rng() % UNIT_TYPE_COUNT);
+        if (state.getMap().isPassable(type, x, y) && state.unitAt(x, y) == -1) state.addUnit(Unit(type, x, y, 1 + i % 2, 0));
+    }
+    return state;
+}
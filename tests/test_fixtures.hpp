@@ -0,0 +1,10 @@
+#pragma once
+
+#include "game_state.hpp"
+
+// Shared starting positions for the tests
+
+// Generated terrain (generateTerrain() with `seed`), and one attempt per
+// `tilesPerUnit` tiles to place a unit of a random type on a random free tile
+// its type can enter; the players take turns placing
+GameState randomBattle(int width, int height, unsigned seed, int tilesPerUnit);
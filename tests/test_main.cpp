@@ -0,0 +1,49 @@
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include "test.hpp"
+
+namespace {
+
+struct Test {
+    const char* name;
+    void (*run)();
+};
+
+std::vector<Test>& registry() {
+    static std::vector<Test> tests;
+    return tests;
+}
+
+int failures = 0;
+
+}
+
+TestRegistration::TestRegistration(const char* name, void (*run)()) {
+    registry().push_back({name, run});
+}
+
+void reportFailure(const char* file, int line, const char* expression) {
+    // Stop the output from flooding when a check in a loop keeps failing
+    if (++failures <= 20) {
+        std::cerr << file << ":" << line << ": CHECK(" << expression << ") failed" << std::endl;
+    }
+}
+
+int main(int argc, char** argv) {
+    const char* prefix = argc > 1 ? argv[1] : "";
+    int run = 0;
+    for (const Test& test : registry()) {
+        if (std::strncmp(test.name, prefix, std::strlen(prefix)) != 0) continue;
+        int before = failures;
+        test.run();
+        std::cout << (failures == before ? "ok    " : "FAIL  ") << test.name << std::endl;
+        run++;
+    }
+    if (run == 0) {
+        std::cerr << "No tests match '" << prefix << "'" << std::endl;
+        return 1;
+    }
+    std::cout << run << " tests, " << failures << " failed checks" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
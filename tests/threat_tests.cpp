@@ -0,0 +1,90 @@
+#include <algorithm>
+#include <cstdlib>
+#include <random>
+#include "ai_player.hpp"
+#include "test.hpp"
+#include "test_fixtures.hpp"
+#include "threat_map.hpp"
+
+namespace {
+
+bool sameLayers(const ThreatMap& a, const ThreatMap& b) {
+    for (int layer = 0; layer < THREAT_LAYER_COUNT; layer++) {
+        for (int player = 1; player <= 2; player++) {
+            for (int y = 0; y < a.getHeight(); y++) {
+                for (int x = 0; x < a.getWidth(); x++) {
+                    ThreatLayer threat = static_cast<ThreatLayer>(layer);
+                    if (a.getDamage(threat, player, x, y) != b.getDamage(threat, player, x, y)) return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// Next-turn damage of `player`'s units on (x, y), counting only those `viewer` sees
+int visibleDamage(const GameState& state, const FogOfWar& fog, int viewer, int player, int x, int y) {
+    const UnitPool& units = state.getUnits();
+    int damage = 0;
+    for (int i = 0; i < units.size(); i++) {
+        if (units.getPlayer(i) != player || !fog.isVisible(viewer, units.getX(i), units.getY(i))) continue;
+        int dx = std::abs(units.getX(i) - x), dy = std::abs(units.getY(i) - y);
+        if ((dx || dy) && std::max(dx, dy) <= units.getAttackRange(i)) damage += units.getAttackDamage(i);
+    }
+    return damage;
+}
+
+}
+
+// The player to move views the board, as in a hot-seat game: the threats
+// against them come from the enemies they can see, kept up to date turn by turn
+TEST(threat_map_counts_only_seen_enemies) {
+    int hiddenThreats = 0;
+    for (int size : {20, 40}) {
+        std::mt19937 rng(size);
+        GameState state = randomBattle(size, size, size, 10);
+        FogOfWar fog;
+        fog.rebuild(state);
+        ThreatMap threats;
+        threats.setSight(&fog, state.getCurrentPlayer());
+        threats.rebuild(state);
+
+        std::vector<AiAction> actions;
+        for (int turn = 0; turn < 80 && state.getWinner() == 0; turn++) {
+            AiPlayer::generateActions(state, actions);
+            if (actions.empty()) break;
+            const AiAction& action = actions[rng() % actions.size()];
+            int enemy = state.getCurrentPlayer() == 1 ? 2 : 1;
+            UnitHandle target;
+            if (action.type == ATTACK) target = state.getHandle(state.unitAt(action.x, action.y));
+            StepResult result;
+            AiPlayer::apply(state, action, &result);
+            if (result.outcome == MOVED) {
+                fog.unitMoved(state, result.unitIndex, result.from, result.to);
+                threats.unitMoved(state, result.unitIndex, result.from, result.to);
+            } else if (result.killed) {
+                fog.unitRemoved(state, enemy, result.to);
+                threats.unitRemoved(state, target);
+            }
+            int viewer = state.getCurrentPlayer();
+            threats.setSight(&fog, viewer);
+
+            ThreatMap fresh;
+            fresh.setSight(&fog, viewer);
+            fresh.rebuild(state);
+            CHECK(sameLayers(threats, fresh));
+            int other = viewer == 1 ? 2 : 1;
+            for (int y = 0; y < size; y++) {
+                for (int x = 0; x < size; x++) {
+                    CHECK(threats.getDamage(THREAT_NEXT_TURN, other, x, y) == visibleDamage(state, fog, viewer, other, x, y));
+                }
+            }
+
+            ThreatMap everything;
+            everything.rebuild(state);
+            if (!sameLayers(everything, fresh)) hiddenThreats++;
+        }
+    }
+    // Some turns had enemies out of sight, or the checks above prove nothing
+    CHECK(hiddenThreats > 0);
+}
@@ -0,0 +1,82 @@
+#include <random>
+#include "ai_player.hpp"
+#include "test.hpp"
+#include "test_fixtures.hpp"
+
+namespace {
+
+bool samePoints(const std::vector<Point>& a, const std::vector<Point>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].x != b[i].x || a[i].y != b[i].y) return false;
+    }
+    return true;
+}
+
+// Everything undo() has to put back: the units in their old order and under
+// their old handles, the grid, the turn, and ranges matching a fresh computation
+void checkRestored(const GameState& state, const GameState& before) {
+    const UnitPool& units = state.getUnits();
+    const UnitPool& old = before.getUnits();
+    CHECK(state.stateHash() == before.stateHash());
+    CHECK(state.getCurrentPlayer() == before.getCurrentPlayer());
+    CHECK(state.getSelectedIndex() == -1);
+    CHECK(units.size() == old.size());
+    if (units.size() != old.size()) return;
+    for (int i = 0; i < units.size(); i++) {
+        CHECK(units.handleAt(i) == old.handleAt(i));
+        CHECK(units.getOrientation(i) == old.getOrientation(i));
+        CHECK(state.unitAt(units.getX(i), units.getY(i)) == i);
+    }
+    const OccupancyGrid& occupancy = state.getOccupancy();
+    for (int y = 0; y < occupancy.getHeight(); y++) {
+        for (int x = 0; x < occupancy.getWidth(); x++) {
+            CHECK(occupancy.at(x, y) == before.getOccupancy().at(x, y));
+            for (int player = 1; player <= 2; player++) {
+                CHECK(occupancy.getPlayerTiles(player).test(x, y) == before.getOccupancy().getPlayerTiles(player).test(x, y));
+            }
+        }
+    }
+    std::vector<Point> fresh;
+    for (int i = 0; i < units.size(); i++) {
+        calculateMovementRange(units.get(i), state.getMap(), occupancy, fresh);
+        CHECK(samePoints(state.getMovementRangeOf(i), fresh));
+        calculateAttackRange(units.get(i), state.getMap(), fresh);
+        CHECK(samePoints(state.getAttackRangeOf(i), fresh));
+    }
+}
+
+}
+
+// Every turn of every position along a game is stepped and undone on the
+// same state, the way the AI search walks its tree
+TEST(undo_restores_the_state_through_a_game) {
+    int killsUndone = 0;
+    for (int size : {7, 13}) {
+        std::mt19937 rng(size);
+        GameState state = randomBattle(size, size, size, 4);
+
+        std::vector<AiAction> actions;
+        for (int turn = 0; turn < 40 && state.getWinner() == 0; turn++) {
+            AiPlayer::generateActions(state, actions);
+            if (actions.empty()) break;
+            GameState before = state;
+            for (const AiAction& action : actions) {
+                StepUndo undo;
+                CHECK(AiPlayer::apply(state, action, undo));
+                // The ranges of the stepped state warm the cache entries the undo must fix
+                for (int i = 0; i < state.getUnits().size(); i++) state.getMovementRangeOf(i);
+                state.undo(undo);
+                if (undo.result.killed) killsUndone++;
+                checkRestored(state, before);
+            }
+            // Prefer attacks, so the game reaches kills
+            size_t pick = rng() % actions.size();
+            for (size_t i = 0; i < actions.size(); i++) {
+                if (actions[i].type == ATTACK && rng() % 2) pick = i;
+            }
+            AiPlayer::apply(state, actions[pick]);
+        }
+    }
+    CHECK(killsUndone > 0);
+}
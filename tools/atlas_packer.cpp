@@ -0,0 +1,247 @@
+#include <SDL.h>
+#include <SDL_image.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#include "atlas_layout.hpp"
+#include "sprite_catalog.hpp"
+
+// Packs every sprite of the catalogue into atlas pages: each frame is cut
+// from its source sheet, scaled to the box it is drawn into at the game's
+// tile size, trimmed to its opaque pixels and shelf-packed. Writes
+// <out>.atlas (see atlas_layout.hpp) and <out>_<page>.png next to it.
+// Run from the repository root, where resources/gfx is.
+
+namespace {
+
+struct Options {
+    std::string out = "atlas/sprites";
+    int tileSize = 64;
+    int pageSize = 1024;
+    int padding = 1;
+};
+
+// RGBA, 4 bytes per pixel, rows packed
+struct Image {
+    int width = 0;
+    int height = 0;
+    std::vector<unsigned char> pixels;
+
+    unsigned char* at(int x, int y) { return &pixels[(static_cast<size_t>(y) * width + x) * 4]; }
+    const unsigned char* at(int x, int y) const { return &pixels[(static_cast<size_t>(y) * width + x) * 4]; }
+};
+
+void printUsage() {
+    std::cerr << "Usage: atlas_packer [--out PREFIX] [--tile-size N] [--page-size N] [--padding N]\n"
+              << "  writes PREFIX.atlas and PREFIX_<page>.png, atlas/sprites by default" << std::endl;
+}
+
+bool loadImage(const std::string& path, Image& image) {
+    SDL_Surface* loaded = IMG_Load(path.c_str());
+    if (!loaded) {
+        std::cerr << "Failed to load image: " << path << ": " << IMG_GetError() << std::endl;
+        return false;
+    }
+    SDL_Surface* rgba = SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_RGBA32, 0);
+    SDL_FreeSurface(loaded);
+    if (!rgba) {
+        std::cerr << "Failed to convert image: " << path << ": " << SDL_GetError() << std::endl;
+        return false;
+    }
+    image.width = rgba->w;
+    image.height = rgba->h;
+    image.pixels.resize(static_cast<size_t>(image.width) * image.height * 4);
+    SDL_LockSurface(rgba);
+    for (int y = 0; y < image.height; y++) {
+        std::memcpy(image.at(0, y), static_cast<const unsigned char*>(rgba->pixels) + y * rgba->pitch, image.width * 4);
+    }
+    SDL_UnlockSurface(rgba);
+    SDL_FreeSurface(rgba);
+    return true;
+}
+
+// Area-weighted resampling of `source` (clipped to the image) to width x
+// height. Colour is averaged premultiplied by alpha, so transparent pixels
+// don't darken the edges of what remains.
+Image resample(const Image& image, SpriteRect source, int width, int height) {
+    int right = std::min(image.width, source.x + source.w), bottom = std::min(image.height, source.y + source.h);
+    source.x = std::max(0, source.x);
+    source.y = std::max(0, source.y);
+    source.w = std::max(0, right - source.x);
+    source.h = std::max(0, bottom - source.y);
+
+    Image scaled;
+    scaled.width = width;
+    scaled.height = height;
+    scaled.pixels.assign(static_cast<size_t>(width) * height * 4, 0);
+    if (source.w == 0 || source.h == 0) return scaled;
+
+    double scaleX = static_cast<double>(source.w) / width, scaleY = static_cast<double>(source.h) / height;
+    for (int y = 0; y < height; y++) {
+        double top = y * scaleY, bottomEdge = (y + 1) * scaleY;
+        for (int x = 0; x < width; x++) {
+            double left = x * scaleX, rightEdge = (x + 1) * scaleX;
+            double sum[4] = {0.0, 0.0, 0.0, 0.0};
+            double area = 0.0;
+            for (int sy = static_cast<int>(top); sy < std::min(source.h, static_cast<int>(std::ceil(bottomEdge))); sy++) {
+                double coverY = std::min(bottomEdge, sy + 1.0) - std::max(top, static_cast<double>(sy));
+                for (int sx = static_cast<int>(left); sx < std::min(source.w, static_cast<int>(std::ceil(rightEdge))); sx++) {
+                    double weight = coverY * (std::min(rightEdge, sx + 1.0) - std::max(left, static_cast<double>(sx)));
+                    const unsigned char* pixel = image.at(source.x + sx, source.y + sy);
+                    double alpha = pixel[3] * weight;
+                    sum[0] += pixel[0] * alpha;
+                    sum[1] += pixel[1] * alpha;
+                    sum[2] += pixel[2] * alpha;
+                    sum[3] += alpha;
+                    area += weight;
+                }
+            }
+            if (sum[3] <= 0.0) continue;
+            unsigned char* out = scaled.at(x, y);
+            for (int channel = 0; channel < 3; channel++) {
+                out[channel] = static_cast<unsigned char>(std::lround(std::min(255.0, sum[channel] / sum[3])));
+            }
+            out[3] = static_cast<unsigned char>(std::lround(std::min(255.0, sum[3] / area)));
+        }
+    }
+    return scaled;
+}
+
+// Bounds of the pixels with any alpha; false when there are none
+bool opaqueBounds(const Image& image, SpriteRect& bounds) {
+    int left = image.width, top = image.height, right = -1, bottom = -1;
+    for (int y = 0; y < image.height; y++) {
+        for (int x = 0; x < image.width; x++) {
+            if (image.at(x, y)[3] == 0) continue;
+            left = std::min(left, x);
+            right = std::max(right, x);
+            top = std::min(top, y);
+            bottom = std::max(bottom, y);
+        }
+    }
+    if (right < 0) return false;
+    bounds = {left, top, right - left + 1, bottom - top + 1};
+    return true;
+}
+
+bool pack(const Options& options) {
+    std::map<std::string, Image> sheets;
+    std::vector<Image> frames(SPRITE_COUNT);
+    AtlasLayout layout;
+    layout.tileSize = options.tileSize;
+    layout.sprites.assign(SPRITE_COUNT, AtlasSprite());
+    size_t sourceBytes = 0;
+
+    for (int sprite = 0; sprite < SPRITE_COUNT; sprite++) {
+        SpriteSource source = spriteSource(sprite, options.tileSize);
+        auto sheet = sheets.find(source.path);
+        if (sheet == sheets.end()) {
+            Image image;
+            if (!loadImage(source.path, image)) return false;
+            sourceBytes += image.pixels.size();
+            sheet = sheets.emplace(source.path, std::move(image)).first;
+        }
+        if (source.source.w == 0) source.source = {0, 0, sheet->second.width, sheet->second.height};
+
+        Image scaled = resample(sheet->second, source.source, source.box.w, source.box.h);
+        SpriteRect bounds;
+        if (!opaqueBounds(scaled, bounds)) continue;
+        AtlasSprite& placed = layout.sprites[sprite];
+        placed.page = 0;
+        placed.w = bounds.w;
+        placed.h = bounds.h;
+        placed.offsetX = source.box.x + bounds.x;
+        placed.offsetY = source.box.y + bounds.y;
+
+        Image& frame = frames[sprite];
+        frame.width = bounds.w;
+        frame.height = bounds.h;
+        frame.pixels.resize(static_cast<size_t>(bounds.w) * bounds.h * 4);
+        for (int y = 0; y < bounds.h; y++) {
+            std::memcpy(frame.at(0, y), scaled.at(bounds.x, bounds.y + y), bounds.w * 4);
+        }
+    }
+
+    if (!packAtlas(layout.sprites, options.pageSize, options.padding, layout.pages)) return false;
+
+    std::filesystem::path prefix(options.out);
+    std::error_code error;
+    if (prefix.has_parent_path()) std::filesystem::create_directories(prefix.parent_path(), error);
+    size_t atlasBytes = 0;
+    for (size_t page = 0; page < layout.pages.size(); page++) {
+        AtlasPage& atlasPage = layout.pages[page];
+        SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, atlasPage.width, atlasPage.height, 32, SDL_PIXELFORMAT_RGBA32);
+        if (!surface) {
+            std::cerr << "Failed to create atlas page: " << SDL_GetError() << std::endl;
+            return false;
+        }
+        SDL_LockSurface(surface);
+        for (int y = 0; y < atlasPage.height; y++) {
+            std::memset(static_cast<unsigned char*>(surface->pixels) + y * surface->pitch, 0, atlasPage.width * 4);
+        }
+        for (int sprite = 0; sprite < SPRITE_COUNT; sprite++) {
+            const AtlasSprite& placed = layout.sprites[sprite];
+            if (placed.page != static_cast<int>(page)) continue;
+            for (int y = 0; y < placed.h; y++) {
+                std::memcpy(static_cast<unsigned char*>(surface->pixels) + (placed.y + y) * surface->pitch + placed.x * 4,
+                            frames[sprite].at(0, y), placed.w * 4);
+            }
+        }
+        SDL_UnlockSurface(surface);
+
+        atlasPage.file = prefix.filename().string() + "_" + std::to_string(page) + ".png";
+        std::string path = options.out + "_" + std::to_string(page) + ".png";
+        bool saved = IMG_SavePNG(surface, path.c_str()) == 0;
+        SDL_FreeSurface(surface);
+        if (!saved) {
+            std::cerr << "Failed to write " << path << ": " << IMG_GetError() << std::endl;
+            return false;
+        }
+        atlasBytes += static_cast<size_t>(atlasPage.width) * atlasPage.height * 4;
+        std::cout << "Wrote " << path << " (" << atlasPage.width << "x" << atlasPage.height << ")" << std::endl;
+    }
+
+    if (!saveAtlasLayout(layout, options.out + ".atlas")) return false;
+    std::cout << "Packed " << SPRITE_COUNT << " sprites from " << sheets.size() << " images into " << layout.pages.size()
+              << " page(s) for " << options.tileSize << " px tiles: " << sourceBytes / 1024 << " KiB of source pixels, "
+              << atlasBytes / 1024 << " KiB packed" << std::endl;
+    return true;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            options.out = argv[++i];
+        } else if (std::strcmp(argv[i], "--tile-size") == 0 && i + 1 < argc) {
+            options.tileSize = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--page-size") == 0 && i + 1 < argc) {
+            options.pageSize = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--padding") == 0 && i + 1 < argc) {
+            options.padding = std::max(0, std::atoi(argv[++i]));
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+    if (options.tileSize < UNIT_FRAME_SIZE || options.pageSize <= 0) {
+        std::cerr << "Tile size must be at least " << UNIT_FRAME_SIZE << " px" << std::endl;
+        return 1;
+    }
+
+    if (!(IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG)) {
+        std::cerr << "IMG_Init Error: " << IMG_GetError() << std::endl;
+        return 1;
+    }
+    bool ok = pack(options);
+    IMG_Quit();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,104 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "binary_layout.hpp"
+#include "map.hpp"
+#include "map_generator.hpp"
+#include "rules.hpp"
+
+// Converts text maps and unit layouts into the binary formats described in
+// binary_layout.hpp, and measures how long each format takes to load.
+
+namespace {
+
+void printUsage() {
+    std::cerr << "Usage:\n"
+              << "  layout_converter map <map.txt> <out.bmap>\n"
+              << "  layout_converter units <player.txt> <player> <out.bunits>\n"
+              << "  layout_converter generate <width> <height> <seed> <out.txt|out.bmap>\n"
+              << "  layout_converter bench <map.txt> <map.bmap> [iterations]" << std::endl;
+}
+
+bool convertMap(const std::string& input, const std::string& output) {
+    int width = 0, height = 0;
+    if (!Map::measureMapFile(input, width, height)) return false;
+    Map map(width, height);
+    if (!map.loadMap(input)) return false;
+    if (!map.saveBinaryMap(output)) return false;
+    std::cout << "Wrote " << width << "x" << height << " map to " << output << std::endl;
+    return true;
+}
+
+bool convertUnits(const std::string& input, int player, const std::string& output) {
+    std::vector<Unit> units;
+    if (!loadUnits(input, player, units)) return false;
+    if (!saveBinaryUnits(units, output)) return false;
+    std::cout << "Wrote " << units.size() << " units to " << output << std::endl;
+    return true;
+}
+
+bool generate(int width, int height, unsigned seed, const std::string& output) {
+    Map map(width, height);
+    generateTerrain(map, seed);
+    bool written = hasExtension(output, ".bmap") ? map.saveBinaryMap(output) : map.saveMap(output);
+    if (written) std::cout << "Wrote generated " << width << "x" << height << " map to " << output << std::endl;
+    return written;
+}
+
+template <typename Load>
+double averageMilliseconds(int iterations, Load load) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        if (!load()) return -1.0;
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+}
+
+bool bench(const std::string& textMap, const std::string& binaryMap, int iterations) {
+    int width = 0, height = 0;
+    if (!Map::measureMapFile(textMap, width, height)) return false;
+
+    double textMs = averageMilliseconds(iterations, [&]() {
+        Map map(width, height);
+        return map.loadMap(textMap);
+    });
+    double binaryMs = averageMilliseconds(iterations, [&]() {
+        Map map(0, 0);
+        return map.loadBinaryMap(binaryMap);
+    });
+    if (textMs < 0 || binaryMs < 0) return false;
+
+    std::cout << width << "x" << height << " map, " << iterations << " loads each\n"
+              << "  text:   " << textMs << " ms\n"
+              << "  binary: " << binaryMs << " ms (" << textMs / binaryMs << "x faster)" << std::endl;
+    return true;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        printUsage();
+        return 1;
+    }
+
+    std::string mode = argv[1];
+    bool ok = false;
+    if (mode == "map" && argc == 4) {
+        ok = convertMap(argv[2], argv[3]);
+    } else if (mode == "units" && argc == 5) {
+        ok = convertUnits(argv[2], std::atoi(argv[3]), argv[4]);
+    } else if (mode == "generate" && argc == 6) {
+        ok = generate(std::atoi(argv[2]), std::atoi(argv[3]), static_cast<unsigned>(std::strtoul(argv[4], nullptr, 10)), argv[5]);
+    } else if (mode == "bench" && (argc == 4 || argc == 5)) {
+        ok = bench(argv[2], argv[3], argc == 5 ? std::max(1, std::atoi(argv[4])) : 5);
+    } else {
+        printUsage();
+        return 1;
+    }
+    return ok ? 0 : 1;
+}
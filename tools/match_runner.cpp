@@ -0,0 +1,367 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "ai_player.hpp"
+#include "battle_setup.hpp"
+#include "thread_pool.hpp"
+
+// Plays batches of headless games between scripted, random or AI policies for
+// balance tuning, and aggregates who won, how long games took and what each
+// unit type achieved. Game g always gets the same seed, and results are
+// combined in game order, so a run is reproducible at any thread count.
+
+namespace {
+
+enum Policy { RANDOM, GREEDY, AI };
+const char* const POLICY_NAMES[] = {"random", "greedy", "ai"};
+const char* const UNIT_TYPE_NAMES[UNIT_TYPE_COUNT] = {"infantry", "tank", "boat", "helicopter"};
+
+struct Setup {
+    long games = 1000;
+    unsigned threads = 0;
+    uint64_t seed = 1;
+    BattleSetup battle;       // a random map is generated per game, from the game's seed
+    Policy policies[2] = {GREEDY, GREEDY};
+    bool swapSides = false;   // odd games hand side 1 to the second policy
+    int maxTurns = 500;
+    int aiDepth = 2;
+    bool scaling = false;
+};
+
+struct TypeStats {
+    long fielded = 0;
+    long damage = 0;
+    long kills = 0;
+    long lost = 0;
+};
+
+struct GameResult {
+    int winner = 0;      // side, 0 for a draw
+    bool swapped = false;
+    int turns = 0;
+    uint64_t finalHash = 0;
+    bool failed = false;  // its generated map or the layouts didn't load
+    TypeStats types[UNIT_TYPE_COUNT];
+};
+
+struct BatchResult {
+    std::vector<GameResult> games;
+    double seconds = 0.0;
+};
+
+void printUsage() {
+    std::cerr << "Usage: match_runner [--games N] [--threads N] [--seed N]\n"
+              << "                    [--map FILE | --random-map WIDTH HEIGHT] [--layout1 FILE] [--layout2 FILE]\n"
+              << "                    [--p1 random|greedy|ai] [--p2 random|greedy|ai] [--swap-sides]\n"
+              << "                    [--max-turns N] [--ai-depth N] [--scaling]" << std::endl;
+}
+
+bool parsePolicy(const char* text, Policy& policy) {
+    for (int i = 0; i < 3; i++) {
+        if (std::strcmp(text, POLICY_NAMES[i]) == 0) {
+            policy = static_cast<Policy>(i);
+            return true;
+        }
+    }
+    std::cerr << "Unknown policy: " << text << std::endl;
+    return false;
+}
+
+uint64_t gameSeed(uint64_t seed, long game) {
+    // splitmix64, so neighbouring games get unrelated streams
+    uint64_t z = seed + (static_cast<uint64_t>(game) + 1) * 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+// Game `game`'s starting state: generated maps are built from its seed
+bool buildGame(const Setup& setup, long game, GameState& state) {
+    BattleSetup battle = setup.battle;
+    battle.terrainSeed = static_cast<unsigned>(gameSeed(setup.seed, game));
+    return loadBattle(battle, state);
+}
+
+// Attack if possible, preferring kills and then the hardest-hitting target;
+// otherwise step as close to the nearest enemy as possible. Ties are broken
+// at random so games between greedy players still differ.
+bool greedyAction(const GameState& state, const std::vector<AiAction>& actions, std::mt19937_64& random, AiAction& chosen) {
+    const UnitPool& units = state.getUnits();
+    long bestScore = LONG_MIN;
+    long ties = 0;
+    auto consider = [&](const AiAction& action, long score) {
+        if (score > bestScore) {
+            bestScore = score;
+            ties = 1;
+            chosen = action;
+        } else if (score == bestScore && random() % ++ties == 0) {
+            chosen = action;
+        }
+    };
+
+    for (const AiAction& action : actions) {
+        if (action.type != ATTACK) continue;
+        int target = state.unitAt(action.x, action.y);
+        bool kills = units.getHealth(target) <= units.getAttackDamage(action.unitIndex);
+        consider(action, (kills ? 1000 : 0) + units.getAttackDamage(target));
+    }
+    if (ties > 0) return true;
+
+    for (const AiAction& action : actions) {
+        int nearest = INT_MAX;
+        for (int i = 0; i < units.size(); i++) {
+            if (units.getPlayer(i) == state.getCurrentPlayer()) continue;
+            nearest = std::min(nearest, std::abs(units.getX(i) - action.x) + std::abs(units.getY(i) - action.y));
+        }
+        consider(action, -static_cast<long>(nearest));
+    }
+    return ties > 0;
+}
+
+GameResult playGame(const Setup& setup, const GameState& initial, long game) {
+    uint64_t seed = gameSeed(setup.seed, game);
+    std::mt19937_64 random(seed);
+    GameResult result;
+    GameState state = initial;
+    if (setup.battle.randomMap() && !buildGame(setup, game, state)) {
+        result.failed = true;
+        return result;
+    }
+
+    result.swapped = setup.swapSides && game % 2 == 1;
+    Policy sidePolicy[3] = {RANDOM, setup.policies[result.swapped ? 1 : 0], setup.policies[result.swapped ? 0 : 1]};
+    // Fixed depth on the calling thread, so AI games are reproducible too
+    std::unique_ptr<AiPlayer> ai[3];
+    for (int side = 1; side <= 2; side++) {
+        if (sidePolicy[side] != AI) continue;
+        AiSettings settings;
+        settings.threads = 1;
+        settings.maxDepth = setup.aiDepth;
+        settings.timeBudgetMs = INT_MAX;
+        settings.tableBits = 16;
+        ai[side] = std::make_unique<AiPlayer>(settings);
+    }
+
+    for (int i = 0; i < state.getUnits().size(); i++) {
+        result.types[state.getUnits().getType(i)].fielded++;
+    }
+
+    std::vector<AiAction> actions;
+    while (result.turns < setup.maxTurns && state.getWinner() == 0) {
+        int side = state.getCurrentPlayer();
+        AiAction action;
+        bool found;
+        if (sidePolicy[side] == AI) {
+            found = ai[side]->chooseAction(state, action);
+        } else {
+            AiPlayer::generateActions(state, actions);
+            if (sidePolicy[side] == RANDOM) {
+                found = !actions.empty();
+                if (found) action = actions[random() % actions.size()];
+            } else {
+                found = greedyAction(state, actions, random, action);
+            }
+        }
+        // No legal turn left counts as a draw
+        if (!found) break;
+
+        // Types are read up front: a kill removes the target from the pool
+        UnitType attackerType = state.getUnits().getType(action.unitIndex);
+        int target = action.type == ATTACK ? state.unitAt(action.x, action.y) : -1;
+        UnitType targetType = target != -1 ? state.getUnits().getType(target) : attackerType;
+        StepResult step;
+        if (!AiPlayer::apply(state, action, &step)) break;
+        result.turns++;
+        if (step.outcome == ATTACKED) {
+            TypeStats& attacker = result.types[attackerType];
+            attacker.damage += step.damage;
+            if (step.killed) {
+                attacker.kills++;
+                result.types[targetType].lost++;
+            }
+        }
+    }
+    result.winner = state.getWinner();
+    result.finalHash = state.stateHash();
+    return result;
+}
+
+BatchResult runBatch(const Setup& setup, const GameState& initial, unsigned threads) {
+    BatchResult batch;
+    batch.games.resize(setup.games);
+    auto start = std::chrono::steady_clock::now();
+    if (threads <= 1) {
+        for (long game = 0; game < setup.games; game++) {
+            batch.games[game] = playGame(setup, initial, game);
+        }
+    } else {
+        // The calling thread runs games too while it waits
+        ThreadPool pool(threads - 1);
+        std::atomic<int> pending(static_cast<int>(setup.games));
+        for (long game = 0; game < setup.games; game++) {
+            pool.submit([&setup, &initial, &batch, &pending, game] {
+                batch.games[game] = playGame(setup, initial, game);
+                pending--;
+            });
+        }
+        pool.wait(pending);
+    }
+    batch.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return batch;
+}
+
+// A game that couldn't be built would otherwise count as a draw
+bool reportFailedGame(const BatchResult& batch) {
+    for (size_t game = 0; game < batch.games.size(); game++) {
+        if (batch.games[game].failed) {
+            std::cerr << "Failed to build game " << game << ", aborting the batch" << std::endl;
+            return true;
+        }
+    }
+    return false;
+}
+
+uint64_t batchChecksum(const BatchResult& batch) {
+    uint64_t hash = 0;
+    for (const GameResult& game : batch.games) {
+        hash = (hash ^ game.finalHash ^ static_cast<uint64_t>(game.turns) << 8 ^ game.winner) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+void printReport(const Setup& setup, const BatchResult& batch, unsigned threads) {
+    long sideWins[3] = {0, 0, 0};
+    long policyWins[2] = {0, 0};
+    long totalTurns = 0;
+    std::vector<int> lengths;
+    TypeStats types[UNIT_TYPE_COUNT];
+    for (const GameResult& game : batch.games) {
+        sideWins[game.winner]++;
+        if (game.winner != 0) policyWins[(game.winner == 1) == game.swapped ? 1 : 0]++;
+        totalTurns += game.turns;
+        lengths.push_back(game.turns);
+        for (int type = 0; type < UNIT_TYPE_COUNT; type++) {
+            types[type].fielded += game.types[type].fielded;
+            types[type].damage += game.types[type].damage;
+            types[type].kills += game.types[type].kills;
+            types[type].lost += game.types[type].lost;
+        }
+    }
+    std::sort(lengths.begin(), lengths.end());
+    long games = static_cast<long>(batch.games.size());
+    auto percent = [games](long count) { return 100.0 * count / std::max(games, 1L); };
+    auto percentile = [&lengths](double p) { return lengths[static_cast<size_t>(p * (lengths.size() - 1))]; };
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << games << " games, " << POLICY_NAMES[setup.policies[0]] << " vs " << POLICY_NAMES[setup.policies[1]]
+              << (setup.swapSides ? " (sides swapped every other game)" : "") << ", seed " << setup.seed << "\n";
+    std::cout << "  side 1 wins: " << sideWins[1] << " (" << percent(sideWins[1]) << "%)\n"
+              << "  side 2 wins: " << sideWins[2] << " (" << percent(sideWins[2]) << "%)\n"
+              << "  draws:       " << sideWins[0] << " (" << percent(sideWins[0]) << "%), turn limit " << setup.maxTurns
+              << " or no legal turn\n";
+    if (setup.swapSides) {
+        std::cout << "  " << POLICY_NAMES[setup.policies[0]] << " (first policy) wins: " << policyWins[0] << " (" << percent(policyWins[0]) << "%)\n"
+                  << "  " << POLICY_NAMES[setup.policies[1]] << " (second policy) wins: " << policyWins[1] << " (" << percent(policyWins[1]) << "%)\n";
+    }
+    if (!lengths.empty()) {
+        std::cout << "  game length in turns: mean " << static_cast<double>(totalTurns) / games << ", median " << percentile(0.5)
+                  << ", p90 " << percentile(0.9) << ", min " << lengths.front() << ", max " << lengths.back() << "\n";
+    }
+
+    std::cout << "  " << std::left << std::setw(12) << "unit type" << std::right << std::setw(10) << "fielded" << std::setw(14) << "damage dealt"
+              << std::setw(16) << "damage / unit" << std::setw(10) << "kills" << std::setw(10) << "lost" << std::setw(12) << "survived" << "\n";
+    for (int type = 0; type < UNIT_TYPE_COUNT; type++) {
+        const TypeStats& stats = types[type];
+        if (stats.fielded == 0) continue;
+        std::cout << "  " << std::left << std::setw(12) << UNIT_TYPE_NAMES[type] << std::right << std::setw(10) << stats.fielded
+                  << std::setw(14) << stats.damage << std::setw(16) << static_cast<double>(stats.damage) / stats.fielded
+                  << std::setw(10) << stats.kills << std::setw(10) << stats.lost
+                  << std::setw(11) << 100.0 * (stats.fielded - stats.lost) / stats.fielded << "%\n";
+    }
+
+    std::cout << "  " << threads << " threads, " << batch.seconds << " s, " << games / std::max(batch.seconds, 1e-9) << " games/s, "
+              << static_cast<long>(totalTurns / std::max(batch.seconds, 1e-9)) << " turns/s" << std::endl;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    Setup setup;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--games") == 0 && i + 1 < argc) {
+            setup.games = std::atol(argv[++i]);
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            setup.threads = static_cast<unsigned>(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            setup.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--map") == 0 && i + 1 < argc) {
+            setup.battle.mapFile = argv[++i];
+        } else if (std::strcmp(argv[i], "--random-map") == 0 && i + 2 < argc) {
+            setup.battle.randomWidth = std::atoi(argv[++i]);
+            setup.battle.randomHeight = std::atoi(argv[++i]);
+        } else if ((std::strcmp(argv[i], "--layout1") == 0 || std::strcmp(argv[i], "--layout2") == 0) && i + 1 < argc) {
+            int side = argv[i][8] - '0';
+            setup.battle.layouts[side] = argv[++i];
+        } else if ((std::strcmp(argv[i], "--p1") == 0 || std::strcmp(argv[i], "--p2") == 0) && i + 1 < argc) {
+            int side = argv[i][3] - '1';
+            if (!parsePolicy(argv[++i], setup.policies[side])) return 1;
+        } else if (std::strcmp(argv[i], "--swap-sides") == 0) {
+            setup.swapSides = true;
+        } else if (std::strcmp(argv[i], "--max-turns") == 0 && i + 1 < argc) {
+            setup.maxTurns = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--ai-depth") == 0 && i + 1 < argc) {
+            setup.aiDepth = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--scaling") == 0) {
+            setup.scaling = true;
+        } else {
+            std::cerr << "Unknown option: " << argv[i] << std::endl;
+            printUsage();
+            return 1;
+        }
+    }
+    // Games are counted down in an int while the pool runs them
+    if (setup.games <= 0 || setup.games > INT_MAX) {
+        printUsage();
+        return 1;
+    }
+
+    unsigned threads = setup.threads > 0 ? setup.threads : std::max(1u, std::thread::hardware_concurrency());
+    // Generated maps are built per game; the first one is built here too, so
+    // missing layouts fail before the batch starts
+    GameState initial(0, 0);
+    if (!buildGame(setup, 0, initial)) return 1;
+
+    BatchResult batch = runBatch(setup, initial, threads);
+    if (reportFailedGame(batch)) return 1;
+    printReport(setup, batch, threads);
+
+    if (setup.scaling) {
+        // Same games at 1, 2, 4, ... threads; the results must not change
+        uint64_t expected = batchChecksum(batch);
+        std::cout << "Scaling (games/s):" << std::endl;
+        std::vector<unsigned> counts;
+        for (unsigned count = 1; count < threads; count *= 2) {
+            counts.push_back(count);
+        }
+        counts.push_back(threads);
+        double single = 0.0;
+        for (unsigned count : counts) {
+            BatchResult run = runBatch(setup, initial, count);
+            if (reportFailedGame(run)) return 1;
+            double rate = setup.games / std::max(run.seconds, 1e-9);
+            if (count == 1) single = rate;
+            std::cout << "  " << std::setw(3) << count << " threads: " << rate << " games/s, x" << std::setprecision(2) << rate / single
+                      << std::setprecision(1) << (batchChecksum(run) == expected ? "" : "  RESULTS DIFFER") << std::endl;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,115 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include "allocation_counter.hpp"
+#include "battle_setup.hpp"
+#include "command_log.hpp"
+
+// Replays recorded matches headless, as fast as the rules run, and checks the
+// state hash after every turn. Also records matches of random clicks, for
+// load tests without playing them by hand.
+
+namespace {
+
+struct Setup {
+    BattleSetup battle;  // the same starting layout the game builds for these options
+    int repeat = 1;
+};
+
+void printUsage() {
+    std::cerr << "Usage:\n"
+              << "  replay play <log.bcl> [options] [--repeat N]\n"
+              << "  replay random <turns> <click seed> <out.bcl> [options]\n"
+              << "Options select the starting layout, as in the game:\n"
+              << "  --map FILE | --random-map WIDTH HEIGHT [--seed N]" << std::endl;
+}
+
+bool play(const std::string& logFile, const Setup& setup) {
+    CommandLog log;
+    if (!log.load(logFile)) return false;
+    GameState initial(0, 0);
+    if (!loadBattle(setup.battle, initial)) return false;
+
+    ReplayResult total;
+    ReplayResult last;
+    // Assigned rather than copied each run, so its buffers stay warm
+    GameState state(0, 0);
+    for (int run = 0; run < setup.repeat; run++) {
+        state = initial;
+        ReplayResult result = log.replay(state);
+        if (!result.ok) {
+            if (result.mismatchTurn >= 0) {
+                std::cerr << "State diverged at turn " << result.mismatchTurn << " (command " << result.commands << ")" << std::endl;
+            }
+            return false;
+        }
+        total.commands += result.commands;
+        total.turns += result.turns;
+        total.seconds += result.seconds;
+        last = result;
+    }
+
+    std::cout << "Replayed " << log.getTurnCount() << " turns (" << total.commands / setup.repeat << " commands, "
+              << log.getByteCount() << " bytes) x" << setup.repeat << ", all state hashes match\n"
+              << "  " << total.seconds * 1000.0 << " ms, " << total.turns / std::max(total.seconds, 1e-9) << " turns/s, "
+              << total.commands / std::max(total.seconds, 1e-9) << " commands/s" << std::endl;
+    // The first run warms the range cache and scratch buffers; later runs
+    // show what a long session allocates per turn
+    if (allocationCountingEnabled()) {
+        std::cout << "  " << last.allocations << " heap allocations in the " << (setup.repeat > 1 ? "last" : "only") << " run, "
+                  << static_cast<double>(last.allocations) / std::max(last.turns, 1L) << " per turn" << std::endl;
+    }
+    return true;
+}
+
+bool recordRandom(long turns, unsigned clickSeed, const std::string& output, const Setup& setup) {
+    GameState state(0, 0);
+    if (!loadBattle(setup.battle, state)) return false;
+    CommandLog log = recordRandomGame(state, turns, clickSeed);
+    if (!log.save(output)) return false;
+    std::cout << "Recorded " << log.getTurnCount() << " turns (" << log.getByteCount() << " bytes) to " << output;
+    if (state.getWinner()) std::cout << ", player " << state.getWinner() << " won";
+    std::cout << std::endl;
+    return true;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        printUsage();
+        return 1;
+    }
+
+    std::string mode = argv[1];
+    std::vector<std::string> positional;
+    Setup setup;
+    for (int i = 2; i < argc; i++) {
+        if (std::strcmp(argv[i], "--map") == 0 && i + 1 < argc) {
+            setup.battle.mapFile = argv[++i];
+        } else if (std::strcmp(argv[i], "--random-map") == 0 && i + 2 < argc) {
+            setup.battle.randomWidth = std::atoi(argv[++i]);
+            setup.battle.randomHeight = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            setup.battle.terrainSeed = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            setup.repeat = std::max(1, std::atoi(argv[++i]));
+        } else {
+            positional.push_back(argv[i]);
+        }
+    }
+
+    bool ok = false;
+    if (mode == "play" && positional.size() == 1) {
+        ok = play(positional[0], setup);
+    } else if (mode == "random" && positional.size() == 3) {
+        ok = recordRandom(std::atol(positional[0].c_str()), static_cast<unsigned>(std::strtoul(positional[1].c_str(), nullptr, 10)),
+                          positional[2], setup);
+    } else {
+        printUsage();
+        return 1;
+    }
+    return ok ? 0 : 1;
+}